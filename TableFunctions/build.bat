@@ -0,0 +1,3 @@
+:: builds every tool in the src folder into the exe folder with g++ from MinGW-w64, which must be on the PATH
+for %%t in (make_table delete_table snapshot_db incremental_backup fsck_db replicate_db build_index set_quota) do g++ -std=c++17 -O2 -static -pthread -o .\exe\%%t.exe .\src\%%t.cpp
+pause :: so the user can read the compiler errors
\ No newline at end of file
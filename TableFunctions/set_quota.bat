@@ -0,0 +1,2 @@
+.\exe\set_quota.exe
+pause :: so the user can read the success message
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "shared.hpp"
+
+int main()
+{
+  std::string database_filepath = get_database_filepath();
+  assert_database_folder_exists(database_filepath);
+
+  std::string table_name, fieldname;
+  std::cout << "Name of the table to index: ";
+  std::cin >> table_name;
+  std::cout << std::endl;
+
+  std::vector<std::string> records = read_table_info(database_filepath);
+  auto record = std::find_if(records.begin(), records.end(), [&](const std::string& record) -> bool { return get_json_string(record, "name") == table_name; });
+  if (record == records.end())
+  {
+    std::cout << "Table does not exist" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Name of the field to index: ";
+  std::cin >> fieldname;
+  std::cout << std::endl;
+
+  std::vector<std::string> fieldnames = get_json_string_array(*record, "fieldnames");
+  auto field = std::find(fieldnames.begin(), fieldnames.end(), fieldname);
+  if (field == fieldnames.end())
+  {
+    std::cout << "Field does not exist in the table" << std::endl;
+    exit(1);
+  }
+
+  ask_direct_io();
+  std::cout << "Building index ..." << std::endl;
+  try
+  {
+    build_index(database_filepath, *record, fieldname, field - fieldnames.begin());
+  }
+  catch (const std::exception& error)
+  {
+    std::cout << "Building the index failed: " << error.what() << std::endl;
+    exit(1);
+  }
+}
@@ -102,6 +102,11 @@ void delete_table(std::string database_filepath, std::string table_name)
 
   eraseFileLine(tables_info_file, line_number);
   std::filesystem::remove_all(database_filepath + table_name);
+  // The entries of a sharded table are stored in each shard's root folder
+  for (std::string root : get_json_string_array(line, "shards")) std::filesystem::remove_all(root + table_name);
+  for (std::string fieldname : get_json_string_array(line, "indexes")) std::filesystem::remove(database_filepath + table_name + "." + fieldname + ".index");
+  // Hash index images saved by the Table class are not recorded in table.info
+  for (std::string fieldname : get_json_string_array(line, "fieldnames")) std::filesystem::remove(database_filepath + table_name + "." + fieldname + ".hash");
 
   tables_info.close();
   std::cout << "Done\n" << std::endl;
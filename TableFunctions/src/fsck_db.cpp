@@ -0,0 +1,247 @@
+#include "shared.hpp"
+#include <mutex>
+
+/**
+ * @brief A table as recorded in the table.info file
+*/
+struct TableRecord
+{
+  std::string name;
+  size_t field_count = 0;
+  bool checksummed = false;
+  std::vector<std::string> folders;
+};
+
+/**
+ * @brief An entry file to verify
+*/
+struct EntryFile
+{
+  std::string table;
+  std::filesystem::path path;
+  size_t field_count;
+  bool checksummed;
+};
+
+/**
+ * @brief Corruption found while checking the database, printed once every table has been checked
+*/
+struct Report
+{
+  std::mutex lock;
+  std::vector<std::string> problems;
+  std::atomic<size_t> verified = 0;
+  std::atomic<size_t> unchecksummed = 0;
+  // the table.info record and the field of every index file that is missing or damaged
+  std::vector<std::pair<std::string, std::string>> damaged_indexes;
+
+  void add(std::string problem)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    problems.push_back(problem);
+  }
+};
+
+/**
+ * @brief Verify the format of an index file written by build_index: a header line with the sequence number and change log position
+ * the index is up to date with, then one "<id> <value>" line per entry
+ * @return The problem found, or an empty string if the index file is well formed
+*/
+std::string check_index_file(std::string index_path)
+{
+  std::ifstream f(index_path, std::ios::binary);
+  std::string line;
+  long long seq;
+  uintmax_t offset;
+  if (!std::getline(f, line) || std::sscanf(line.c_str(), "seq %lld %ju", &seq, &offset) != 2) return "header line is missing or damaged";
+
+  for (size_t line_number = 2; std::getline(f, line); line_number++)
+  {
+    size_t separator = line.find(' ');
+    if (separator == std::string::npos || !is_entry_filename(line.substr(0, separator))) return "line " + std::to_string(line_number) + " is damaged";
+  }
+
+  return "";
+}
+
+/**
+ * @brief Verify every line of the table.info file and get the tables recorded in it
+*/
+std::vector<TableRecord> check_table_info(std::string database_filepath, Report& report)
+{
+  std::vector<TableRecord> tables;
+  std::ifstream f(database_filepath + "table.info");
+  std::string line;
+  int line_number = 0;
+
+  while (std::getline(f, line))
+  {
+    line_number++;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) continue;
+
+    std::string location = "table.info line " + std::to_string(line_number);
+    if (line.front() != '{' || line.back() != '}')
+    {
+      report.add(location + ": not a JSON record");
+      continue;
+    }
+
+    size_t checksum_index = line.rfind(",\"crc32c\":\"");
+    if (checksum_index != std::string::npos)
+    {
+      std::string record = line.substr(0, checksum_index) + "}";
+      std::string stored_checksum = get_json_string(line.substr(checksum_index), "crc32c");
+      std::string checksum = format_checksum(crc32c(record.data(), record.size()));
+      if (stored_checksum != checksum) report.add(location + ": checksum is " + checksum + ", expected " + stored_checksum);
+    }
+
+    TableRecord table;
+    table.name = get_json_string(line, "name");
+    table.field_count = get_json_string_array(line, "fieldnames").size();
+    table.checksummed = get_json_string(line, "checksummed") == "true";
+    if (table.name.empty() || table.field_count == 0)
+    {
+      report.add(location + ": missing table name or fieldnames");
+      continue;
+    }
+
+    for (std::string folder : get_table_folders(database_filepath, line))
+    {
+      if (!std::filesystem::is_directory(folder)) report.add(location + ": folder " + folder + " of table \"" + table.name + "\" does not exist");
+      else table.folders.push_back(folder);
+    }
+    std::vector<std::string> fieldnames = get_json_string_array(line, "fieldnames");
+    for (std::string fieldname : get_json_string_array(line, "indexes"))
+    {
+      std::string index_file = table.name + "." + fieldname + ".index";
+      std::string problem = std::filesystem::exists(database_filepath + index_file) ? check_index_file(database_filepath + index_file) : "does not exist";
+      if (problem.empty()) continue;
+
+      report.add(location + ": index file " + index_file + " " + problem);
+      if (std::find(fieldnames.begin(), fieldnames.end(), fieldname) != fieldnames.end()) report.damaged_indexes.push_back({ line, fieldname });
+    }
+    tables.push_back(table);
+  }
+
+  return tables;
+}
+
+/**
+ * @brief Verify the field count and checksum of an entry file, in the same way the Table class does when reading it
+ * @param contents The contents of the entry file
+*/
+void check_entry(const EntryFile& entry, const std::string& contents, Report& report)
+{
+  std::string location = entry.table + "/" + entry.path.filename().string();
+
+  size_t line_count = std::count(contents.begin(), contents.end(), '\n') + 1;
+  if (line_count < entry.field_count)
+  {
+    report.add(location + ": truncated, found " + std::to_string(line_count) + " of " + std::to_string(entry.field_count) + " fields");
+    return;
+  }
+
+  if (line_count == entry.field_count && entry.checksummed)
+  {
+    report.add(location + ": truncated, its checksum line is missing");
+    return;
+  }
+
+  if (line_count == entry.field_count)
+  {
+    // written before checksums were added
+    report.unchecksummed++;
+    report.verified++;
+    return;
+  }
+
+  size_t trailer_start = contents.rfind('\n') + 1;
+  if (line_count > entry.field_count + 1 || contents.compare(trailer_start, 7, "crc32c:") != 0)
+  {
+    report.add(location + ": found " + std::to_string(line_count) + " lines, expected " + std::to_string(entry.field_count) + " fields and a checksum");
+    return;
+  }
+
+  std::string stored_checksum = contents.substr(trailer_start + 7);
+  std::string checksum = format_checksum(crc32c(contents.data(), trailer_start - 1));
+  if (stored_checksum != checksum) report.add(location + ": checksum is " + checksum + ", expected " + stored_checksum);
+  else report.verified++;
+}
+
+/**
+ * @brief Verify the table.info file, the index files and every entry of every table, reading the entries ahead of verifying them on every core.
+ * The shards and partitions of a table are verified in parallel like any other folder
+*/
+void check_database(std::string database_filepath, Report& report)
+{
+  std::vector<TableRecord> tables = check_table_info(database_filepath, report);
+  std::vector<EntryFile> entries;
+
+  for (const TableRecord& table : tables)
+  {
+    for (std::string folder : table.folders)
+    {
+      for (const auto& file : std::filesystem::directory_iterator(folder))
+      {
+        if (is_entry_filename(file.path().filename().string())) entries.push_back({ table.name, file.path(), table.field_count, table.checksummed });
+      }
+    }
+  }
+
+  for (const auto& folder : std::filesystem::directory_iterator(database_filepath))
+  {
+    std::string name = folder.path().filename().string();
+    bool recorded = std::any_of(tables.begin(), tables.end(), [&](const TableRecord& table) -> bool { return table.name == name; });
+    // the writes folder holds the markers of the writes in progress, see WriteFreeze, and backup.links the entries staged by incremental_backup
+    if (folder.is_directory() && !recorded && name != "writes" && name != "backup.links") report.add(name + ": folder is not recorded in table.info");
+  }
+
+  std::vector<std::filesystem::path> paths;
+  for (const EntryFile& entry : entries) paths.push_back(entry.path);
+  scan_files(paths, [&](size_t i, std::string& contents) { check_entry(entries[i], contents, report); });
+}
+
+int main()
+{
+  std::string database_filepath = get_database_filepath();
+  assert_database_folder_exists(database_filepath);
+
+  ask_direct_io();
+  std::cout << "Checking database ..." << std::endl;
+  Report report;
+  check_database(database_filepath, report);
+
+  std::sort(report.problems.begin(), report.problems.end());
+  for (const std::string& problem : report.problems) std::cout << problem << std::endl;
+
+  std::cout << report.verified << " entries verified (" << report.unchecksummed << " without a checksum), "
+            << report.problems.size() << " problems found" << std::endl;
+
+  // an index holds nothing that is not in the entries of its table, so it is rebuilt from them the same way build_index builds it
+  size_t rebuilt = 0;
+  if (!report.damaged_indexes.empty())
+  {
+    std::string answer;
+    std::cout << "Rebuild the " << report.damaged_indexes.size() << " missing or damaged indexes from the entries of their tables? (y/n): ";
+    std::cin >> answer;
+    std::cout << std::endl;
+
+    for (const auto& [record, fieldname] : report.damaged_indexes)
+    {
+      if (answer != "y") break;
+      std::vector<std::string> fieldnames = get_json_string_array(record, "fieldnames");
+      try
+      {
+        build_index(database_filepath, record, fieldname, std::find(fieldnames.begin(), fieldnames.end(), fieldname) - fieldnames.begin());
+        rebuilt++;
+      }
+      catch (const std::exception& error)
+      {
+        std::cout << "Rebuilding the index failed: " << error.what() << std::endl;
+      }
+    }
+  }
+
+  if (report.problems.size() > rebuilt) exit(1);
+}
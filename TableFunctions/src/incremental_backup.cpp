@@ -0,0 +1,298 @@
+#include "shared.hpp"
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+/**
+ * @brief An entry as recorded in a backup manifest
+*/
+struct BackupEntry
+{
+  std::string table;
+  std::string id;
+  uintmax_t size = 0;
+  long long modified = 0;
+  uint32_t checksum = 0;
+};
+
+/**
+ * @brief The entries recorded in a backup manifest, keyed by "table/id"
+*/
+typedef std::map<std::string, BackupEntry> Manifest;
+
+/**
+ * @brief Get the folder where backups are stored
+*/
+std::string get_backups_filepath()
+{
+  return "../backups/";
+}
+
+/**
+ * @brief Get the numbers of the existing backups in the order they were taken.
+ * A folder without a manifest is a backup that failed partway before backups were written to a temporary folder, and is skipped
+*/
+std::vector<int> get_backup_numbers(std::string backups_filepath)
+{
+  std::vector<int> numbers;
+  if (!std::filesystem::exists(backups_filepath)) return numbers;
+
+  for (const auto& backup : std::filesystem::directory_iterator(backups_filepath))
+  {
+    if (backup.is_directory() && is_entry_filename(backup.path().filename().string()) && std::filesystem::exists(backup.path() / "backup.manifest"))
+      numbers.push_back(std::stoi(backup.path().filename().string()));
+  }
+
+  std::sort(numbers.begin(), numbers.end());
+  return numbers;
+}
+
+/**
+ * @brief Read the manifest of a backup
+ * @param deleted Filled with the "table/id" keys of the entries deleted since the previous backup
+*/
+Manifest read_manifest(std::string backup_path, std::vector<std::string>* deleted = nullptr)
+{
+  Manifest manifest;
+  std::ifstream f(backup_path + "backup.manifest");
+  std::string line;
+
+  while (std::getline(f, line))
+  {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+
+    if (kind == "entry")
+    {
+      BackupEntry entry;
+      fields >> entry.table >> entry.id >> entry.size >> entry.modified >> std::hex >> entry.checksum;
+      manifest[entry.table + "/" + entry.id] = entry;
+    }
+    else if (kind == "deleted" && deleted)
+    {
+      std::string table, id;
+      fields >> table >> id;
+      deleted->push_back(table + "/" + id);
+    }
+  }
+
+  return manifest;
+}
+
+/**
+ * @brief Write the manifest of a backup, which lists every entry in the database at the time of the backup
+*/
+void write_manifest(std::string backup_path, const Manifest& manifest, const std::vector<std::string>& deleted)
+{
+  std::ofstream f(backup_path + "backup.manifest");
+  f << "created " << std::time(nullptr) << std::endl;
+
+  for (const auto& [key, entry] : manifest)
+  {
+    f << "entry " << entry.table << " " << entry.id << " " << entry.size << " " << entry.modified << " "
+      << std::hex << std::setw(8) << std::setfill('0') << entry.checksum << std::dec << std::endl;
+  }
+
+  for (const std::string& key : deleted)
+  {
+    f << "deleted " << key.substr(0, key.find('/')) << " " << key.substr(key.find('/') + 1) << std::endl;
+  }
+}
+
+/**
+ * @brief Copy an entry file into a backup, taking its checksum from the bytes read for the copy
+ * @return Whether the copy was written
+*/
+bool copy_entry(std::string source, std::string target, uint32_t& checksum)
+{
+  std::string contents = read_file_once(source);
+  checksum = crc32c(contents.data(), contents.size());
+  std::ofstream f(target, std::ios::binary);
+  f.write(contents.data(), contents.size());
+  f.close();
+  return f.good();
+}
+
+/**
+ * @brief Back up the entries created or changed since the previous backup, and record the entries deleted since then.
+ * The first backup contains every entry. The backup is written to a "<n>.tmp" folder which is renamed once the manifest is written,
+ * so a backup that fails partway is never read as the previous backup nor applied by a restore.
+ * While writes are frozen the changed entries are only hard-linked into a staging folder in the database folder, as snapshot_database does,
+ * and they are copied into the backup once writes resume. Entries on another volume, such as shards, are copied while writes are frozen
+*/
+void backup(std::string database_filepath, std::string backups_filepath)
+{
+  std::vector<int> numbers = get_backup_numbers(backups_filepath);
+  Manifest previous = numbers.empty() ? Manifest() : read_manifest(backups_filepath + std::to_string(numbers.back()) + "/");
+  std::string number = std::to_string(numbers.empty() ? 1 : numbers.back() + 1);
+  std::string final_path = backups_filepath + number + "/";
+  std::string backup_path = backups_filepath + number + ".tmp/";
+  std::string staging_path = database_filepath + "backup.links/";
+
+  Manifest current;
+  std::vector<BackupEntry*> changed;
+  std::vector<BackupEntry*> staged;
+  std::vector<std::string> deleted;
+  std::atomic<size_t> failed = 0;
+  // left over from a backup that failed
+  std::filesystem::remove_all(backup_path);
+  std::filesystem::remove_all(staging_path);
+  std::filesystem::create_directories(backup_path);
+
+  {
+    WriteFreeze freeze(database_filepath);
+
+    copy_table_info_flat(database_filepath, backup_path);
+
+    for (std::string record : read_table_info(database_filepath))
+    {
+      for (std::string folder : get_table_folders(database_filepath, record))
+      {
+        if (!std::filesystem::is_directory(folder)) continue;
+
+        for (const auto& file : std::filesystem::directory_iterator(folder))
+        {
+          if (!is_entry_filename(file.path().filename().string())) continue;
+
+          BackupEntry entry;
+          entry.table = get_json_string(record, "name");
+          entry.id = file.path().filename().string();
+          entry.size = file.file_size();
+          entry.modified = file.last_write_time().time_since_epoch().count();
+
+          // An entry with the same size and modification time as in the previous backup is unchanged,
+          // entries are always replaced by a new file when they are written
+          auto found = previous.find(entry.table + "/" + entry.id);
+          bool unchanged = found != previous.end() && found->second.size == entry.size && found->second.modified == entry.modified;
+          if (unchanged) entry.checksum = found->second.checksum;
+
+          BackupEntry& stored = current[entry.table + "/" + entry.id] = entry;
+          if (unchanged) continue;
+
+          std::filesystem::create_directories(backup_path + entry.table);
+          std::filesystem::create_directories(staging_path + entry.table);
+          changed.push_back(&stored);
+
+          std::error_code error;
+          std::filesystem::create_hard_link(file.path(), staging_path + entry.table + "/" + entry.id, error);
+          if (!error) staged.push_back(&stored);
+          else if (!copy_entry(file.path().string(), backup_path + entry.table + "/" + entry.id, stored.checksum)) failed++;
+        }
+      }
+    }
+  }
+
+  // A staged link keeps the entry as it was during the freeze, as writes replace entry files instead of modifying them
+  parallel_for(staged.size(), [&](size_t i)
+  {
+    std::string key = staged[i]->table + "/" + staged[i]->id;
+    if (!copy_entry(staging_path + key, backup_path + key, staged[i]->checksum)) failed++;
+  });
+  std::filesystem::remove_all(staging_path);
+  if (failed) throw std::filesystem::filesystem_error(std::to_string(failed) + " entries could not be copied", backup_path, std::make_error_code(std::errc::io_error));
+
+  for (const auto& [key, entry] : previous)
+  {
+    if (current.find(key) == current.end()) deleted.push_back(key);
+  }
+
+  write_manifest(backup_path, current, deleted);
+  std::filesystem::rename(backup_path, final_path);
+  std::cout << changed.size() << " entries backed up, " << deleted.size() << " entries deleted since the previous backup" << std::endl;
+  std::cout << "Backup saved in " << final_path << std::endl;
+}
+
+/**
+ * @brief Rebuild the database in restore_path by applying every backup in the order they were taken,
+ * then verify the checksum of every restored entry against the latest manifest
+*/
+void restore(std::string backups_filepath, std::string restore_path)
+{
+  std::vector<int> numbers = get_backup_numbers(backups_filepath);
+  if (numbers.empty())
+  {
+    std::cout << "There are no backups to restore" << std::endl;
+    exit(1);
+  }
+
+  std::filesystem::create_directories(restore_path);
+  Manifest manifest;
+
+  for (int number : numbers)
+  {
+    std::string backup_path = backups_filepath + std::to_string(number) + "/";
+    std::vector<std::string> deleted;
+    manifest = read_manifest(backup_path, &deleted);
+
+    for (const std::string& key : deleted) std::filesystem::remove(restore_path + key);
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(backup_path))
+    {
+      if (file.is_directory() || file.path().filename() == "backup.manifest") continue;
+      std::filesystem::path target = restore_path / std::filesystem::relative(file.path(), backup_path);
+      std::filesystem::create_directories(target.parent_path());
+      std::filesystem::copy_file(file.path(), target, std::filesystem::copy_options::overwrite_existing);
+    }
+  }
+
+  std::vector<const BackupEntry*> entries;
+  for (const auto& [key, entry] : manifest) entries.push_back(&entry);
+
+  std::atomic<size_t> corrupted = 0;
+  parallel_for(entries.size(), [&](size_t i)
+  {
+    std::string path = restore_path + entries[i]->table + "/" + entries[i]->id;
+    if (std::filesystem::exists(path) && file_crc32c(path) == entries[i]->checksum) return;
+    corrupted++;
+    std::cout << "Checksum mismatch: " + path + "\n";
+  });
+
+  std::cout << entries.size() << " entries restored from " << numbers.size() << " backups into " << restore_path << std::endl;
+  if (corrupted)
+  {
+    std::cout << corrupted << " entries failed checksum verification" << std::endl;
+    exit(1);
+  }
+}
+
+/**
+ * @brief Get the folder to restore the backups into, which must not already exist
+*/
+std::string get_restore_path()
+{
+  std::string restore_folder;
+  std::cout << "Folder to restore into (e.g. ../restored): ";
+  std::cin >> restore_folder;
+  std::cout << std::endl;
+
+  if (std::filesystem::exists(restore_folder))
+  {
+    std::cout << "Folder already exists" << std::endl;
+    exit(1);
+  }
+
+  return restore_folder + "/";
+}
+
+int main()
+{
+  std::string database_filepath = get_database_filepath();
+  assert_database_folder_exists(database_filepath);
+
+  std::string answer;
+  std::cout << "Backup or restore? (b/r): ";
+  std::cin >> answer;
+  std::cout << std::endl;
+
+  try
+  {
+    if (answer == "b") backup(database_filepath, get_backups_filepath());
+    else if (answer == "r") restore(get_backups_filepath(), get_restore_path());
+  }
+  catch (const std::filesystem::filesystem_error& error)
+  {
+    std::cout << (answer == "b" ? "Backup" : "Restore") << " failed: " << error.what() << std::endl;
+    exit(1);
+  }
+}
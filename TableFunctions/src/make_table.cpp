@@ -48,19 +48,144 @@ std::string get_table_name()
   return table_name;
 }
 
-std::string json_stringify(std::string name, std::string table_folder_path, std::vector<std::string> fieldnames)
+/**
+ * @brief Ask for the root folders of the table's shards, each shard's entries are stored in the table-named folder inside its root folder
+ * @return The root folders, or no folders for an unsharded table
+*/
+std::vector<std::string> get_shard_roots()
 {
-  std::string formatted_fieldnames = "";
-  for (int i = 0; i < fieldnames.size(); i++)
+  std::string answer;
+  std::cout << "Number of shards (1 for an unsharded table): ";
+  std::cin >> answer;
+  std::cout << std::endl;
+
+  if (answer.empty() || any_of(answer.begin(), answer.end(), [](const char& c) -> bool { return !isdigit(c); }))
+  {
+    std::cout << "Number of shards must be a number" << std::endl;
+    exit(1);
+  }
+
+  std::vector<std::string> roots;
+  int shard_count = std::stoi(answer);
+  for (int i = 0; shard_count > 1 && i < shard_count; i++)
+  {
+    std::string root;
+    std::cout << "Absolute root folder of shard " << i + 1 << " (e.g. D:/mdb/): ";
+    std::cin >> root;
+    std::cout << std::endl;
+
+    // The root is stored in table.info, where forward slashes need no escaping
+    std::replace(root.begin(), root.end(), '\\', '/');
+    if (!std::filesystem::path(root).is_absolute())
+    {
+      std::cout << "Shard root folder must be an absolute path" << std::endl;
+      exit(1);
+    }
+
+    roots.push_back(root.back() == '/' ? root : root + "/");
+  }
+
+  return roots;
+}
+
+/**
+ * @brief Ask for the field whose value decides the shard an entry is stored in
+*/
+std::string get_shard_key(std::vector<std::string> fieldnames)
+{
+  std::string shard_key;
+  std::cout << "Shard entries by field (id to shard by entry id): ";
+  std::cin >> shard_key;
+  std::cout << std::endl;
+
+  if (shard_key != "id" && std::find(fieldnames.begin(), fieldnames.end(), shard_key) == fieldnames.end())
+  {
+    std::cout << "Shard field must be id or one of the table's fields" << std::endl;
+    exit(1);
+  }
+
+  return shard_key;
+}
+
+/**
+ * @brief Ask for the field whose value decides the partition an entry is stored in, and the range of values each partition holds
+ * @param partition_width Set to the number of field values each partition holds, e.g. 86400000 for one partition per day of millisecond timestamps
+ * @return The field, or an empty string for an unpartitioned table
+*/
+std::string get_partition_key(std::vector<std::string> fieldnames, std::string& partition_width)
+{
+  std::string partition_key;
+  std::cout << "Partition entries by field (none for an unpartitioned table): ";
+  std::cin >> partition_key;
+  std::cout << std::endl;
+
+  if (partition_key == "none") return "";
+  if (std::find(fieldnames.begin(), fieldnames.end(), partition_key) == fieldnames.end())
+  {
+    std::cout << "Partition field must be none or one of the table's fields" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Values per partition (e.g. 86400000 for days of millisecond timestamps): ";
+  std::cin >> partition_width;
+  std::cout << std::endl;
+
+  if (partition_width.empty() || any_of(partition_width.begin(), partition_width.end(), [](const char& c) -> bool { return !isdigit(c); }) || std::stoll(partition_width) == 0)
   {
-    formatted_fieldnames += "\"" + fieldnames[i] + "\"";
-    if (i != fieldnames.size() - 1)
+    std::cout << "Values per partition must be a positive number" << std::endl;
+    exit(1);
+  }
+
+  return partition_key;
+}
+
+/**
+ * @brief Ask for the field holding the time an entry expires at, in milliseconds since the epoch
+ * @return The field, or an empty string if the table's entries never expire
+*/
+std::string get_ttl_field(std::vector<std::string> fieldnames)
+{
+  std::string ttl_field;
+  std::cout << "Expire entries at the time in field (none for entries that never expire): ";
+  std::cin >> ttl_field;
+  std::cout << std::endl;
+
+  if (ttl_field == "none") return "";
+  if (std::find(fieldnames.begin(), fieldnames.end(), ttl_field) == fieldnames.end())
+  {
+    std::cout << "Expiry field must be none or one of the table's fields" << std::endl;
+    exit(1);
+  }
+
+  return ttl_field;
+}
+
+std::string json_stringify_array(std::vector<std::string> values)
+{
+  std::string formatted_values = "";
+  for (int i = 0; i < values.size(); i++)
+  {
+    formatted_values += "\"" + values[i] + "\"";
+    if (i != values.size() - 1)
     {
-      formatted_fieldnames += ",";
+      formatted_values += ",";
     }
   }
 
-  return "{\"name\":\"" + name + "\",\"folder\":\"" + table_folder_path + "\",\"fieldnames\":[" + formatted_fieldnames + "]}";
+  return "[" + formatted_values + "]";
+}
+
+std::string json_stringify(std::string name, std::string table_folder_path, std::vector<std::string> fieldnames, std::vector<std::string> shard_roots, std::string shard_key, std::string partition_key, std::string partition_width, std::string ttl_field, std::string io_quota, std::string cpu_quota)
+{
+  std::string json = "{\"name\":\"" + name + "\",\"folder\":\"" + table_folder_path + "\",\"fieldnames\":" + json_stringify_array(fieldnames);
+  if (!shard_roots.empty()) json += ",\"shards\":" + json_stringify_array(shard_roots);
+  if (shard_key != "id") json += ",\"shard_key\":\"" + shard_key + "\"";
+  if (!partition_key.empty()) json += ",\"partition_key\":\"" + partition_key + "\",\"partition_width\":\"" + partition_width + "\"";
+  if (!ttl_field.empty()) json += ",\"ttl_field\":\"" + ttl_field + "\"";
+  if (!io_quota.empty()) json += ",\"io_quota\":\"" + io_quota + "\"";
+  if (!cpu_quota.empty()) json += ",\"cpu_quota\":\"" + cpu_quota + "\"";
+  // every entry of a new table is written with a checksum line, so fsck_db and the Table class treat an entry without one as truncated
+  return json + ",\"checksummed\":\"true\"}";
 }
 
 int main() {
@@ -75,8 +200,20 @@ int main() {
     std::cout << "Table must have at least one field" << std::endl;
     exit(1);
   }
-  
-  std::filesystem::create_directory(table_path);
+
+  std::vector<std::string> shard_roots = get_shard_roots();
+  std::string shard_key = shard_roots.empty() ? "id" : get_shard_key(fieldnames);
+
+  // A table is either sharded or partitioned, the partitions are folders inside the table's folder in the database folder
+  std::string partition_width;
+  std::string partition_key = shard_roots.empty() ? get_partition_key(fieldnames, partition_width) : "";
+  std::string ttl_field = get_ttl_field(fieldnames);
+  std::string io_quota = get_quota("I/O quota in bytes read and written per second (0 for no limit): ");
+  std::string cpu_quota = get_quota("CPU quota in milliseconds of processing per second (0 for no limit): ");
+
+  if (shard_roots.empty()) std::filesystem::create_directory(table_path);
+  for (std::string root : shard_roots) std::filesystem::create_directories(root + table_name);
+
   std::string tables_info_file = database_filepath + "table.info";
   std::ofstream f;
   
@@ -86,7 +223,7 @@ int main() {
     f.open(tables_info_file, std::ios::out);
   
   // substr for removing one dir level; from '../database/' to './database/'
-  f << json_stringify(table_name, table_path.substr(1), fieldnames) << std::endl;
+  f << add_table_info_checksum(json_stringify(table_name, table_path.substr(1), fieldnames, shard_roots, shard_key, partition_key, partition_width, ttl_field, io_quota, cpu_quota)) << std::endl;
   f.close();
 
   std::cout << "Table created successfully" << std::endl;
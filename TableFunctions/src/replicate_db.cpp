@@ -0,0 +1,285 @@
+#include "shared.hpp"
+
+/**
+ * @brief The position of the replica in the change log of the primary database
+*/
+struct ReplicaState
+{
+  uintmax_t offset = 0;
+  long long applied_seq = 0;
+  long long lag_ms = 0;
+};
+
+/**
+ * @brief Get the current time in milliseconds since the epoch, the unit of the change log timestamps
+*/
+long long now_ms()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Get a folder path from the user, ending with a slash
+*/
+std::string get_folder(std::string prompt)
+{
+  std::string folder;
+  std::cout << prompt;
+  std::cin >> folder;
+  std::cout << std::endl;
+  return folder.back() == '/' ? folder : folder + "/";
+}
+
+/**
+ * @brief Read the fieldnames of every table in the table.info file of a database
+*/
+std::map<std::string, std::vector<std::string>> read_fieldnames(std::string database_filepath)
+{
+  std::map<std::string, std::vector<std::string>> fieldnames;
+  std::ifstream f(database_filepath + "table.info");
+  std::string line;
+
+  while (std::getline(f, line))
+  {
+    if (!line.empty()) fieldnames[get_json_string(line, "name")] = get_json_string_array(line, "fieldnames");
+  }
+
+  return fieldnames;
+}
+
+/**
+ * @brief Write an entry file the same way the Table class does, to a temporary file which then replaces the entry file
+*/
+void write_entry(std::string table_path, std::string id, const std::vector<std::string>& values)
+{
+  std::string temp_path = table_path + "." + id + ".tmp";
+  std::ofstream f(temp_path, std::ios::binary);
+  f << format_entry(values);
+  f.close();
+  std::filesystem::rename(temp_path, table_path + id);
+}
+
+/**
+ * @brief Write the state of the replica, read by Database.get_replication_status()
+*/
+void write_state(std::string replica_filepath, const ReplicaState& state)
+{
+  std::string temp_path = replica_filepath + "replica.state.tmp";
+  std::ofstream f(temp_path);
+  f << "offset " << state.offset << std::endl;
+  f << "applied_seq " << state.applied_seq << std::endl;
+  f << "lag_ms " << state.lag_ms << std::endl;
+  f << "updated_at " << now_ms() << std::endl;
+  f.close();
+  std::filesystem::rename(temp_path, replica_filepath + "replica.state");
+}
+
+/**
+ * @brief Read the state of the replica
+ * @return false if the replica has not been initialized
+*/
+bool read_state(std::string replica_filepath, ReplicaState& state)
+{
+  std::ifstream f(replica_filepath + "replica.state");
+  if (!f) return false;
+
+  std::string key;
+  while (f >> key)
+  {
+    if (key == "offset") f >> state.offset;
+    else if (key == "applied_seq") f >> state.applied_seq;
+    else f >> state.lag_ms;
+  }
+
+  // the lag is measured again once replication resumes
+  state.lag_ms = 0;
+  return true;
+}
+
+/**
+ * @brief Create the replica from a snapshot of the primary database, taken while writes to the primary are frozen.
+ * Entries that cannot be hard-linked, as the replica is on another volume, are copied once writes resume:
+ * a copy made after the snapshot may already hold later changes, which replaying the change log from the snapshot's offset writes again
+*/
+ReplicaState initialize_replica(std::string primary_filepath, std::string replica_filepath)
+{
+  std::cout << "Copying primary database ..." << std::endl;
+  std::vector<std::pair<std::filesystem::path, std::filesystem::path>> unlinked;
+  {
+    WriteFreeze freeze(primary_filepath);
+    snapshot_database(primary_filepath, replica_filepath, &unlinked);
+  }
+
+  for (const auto& [entry, replica_entry] : unlinked)
+  {
+    // an entry deleted since the snapshot is deleted from the replica by its change
+    std::error_code error;
+    std::filesystem::copy_file(entry, replica_entry, error);
+    if (error && std::filesystem::exists(entry)) throw std::filesystem::filesystem_error("Copying the entry failed", entry, replica_entry, error);
+  }
+
+  ReplicaState state;
+  std::ifstream manifest(replica_filepath + "snapshot.info");
+  std::string key;
+  while (manifest >> key)
+  {
+    if (key == "changes_offset") manifest >> state.offset;
+  }
+
+  state.applied_seq = read_seq_before(primary_filepath + "changes.log", state.offset);
+  write_state(replica_filepath, state);
+  return state;
+}
+
+/**
+ * @brief Apply a change of the primary database to the replica
+*/
+void apply_change(std::string primary_filepath, std::string replica_filepath, std::map<std::string, std::vector<std::string>>& fieldnames, const Change& change)
+{
+  if (fieldnames.find(change.table) == fieldnames.end())
+  {
+    // the table was created after the replica was initialized
+    copy_table_info_flat(primary_filepath, replica_filepath);
+    fieldnames = read_fieldnames(replica_filepath);
+  }
+
+  std::string table_path = replica_filepath + change.table + "/";
+  const std::vector<std::string>& names = fieldnames[change.table];
+  std::filesystem::create_directories(table_path);
+
+  if (change.op == "delete")
+  {
+    std::filesystem::remove(table_path + change.id);
+    return;
+  }
+
+  std::vector<std::string> values = change.op == "patch" ? read_entry(table_path + change.id, names.size()) : std::vector<std::string>(names.size());
+  if (values.size() != names.size())
+  {
+    std::cout << "Skipping change " << change.seq << ": entry " << change.table << "/" << change.id << " does not exist in the replica" << std::endl;
+    return;
+  }
+
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    auto field = change.fields.find(names[i]);
+    if (field != change.fields.end()) values[i] = field->second;
+  }
+
+  write_entry(table_path, change.id, values);
+}
+
+/**
+ * @brief Follow the change log of the primary database and apply every change to the replica, until the tool is closed
+*/
+void replicate(std::string primary_filepath, std::string replica_filepath, ReplicaState state)
+{
+  std::string change_log = primary_filepath + "changes.log";
+  std::map<std::string, std::vector<std::string>> fieldnames = read_fieldnames(replica_filepath);
+  long long last_state_write = 0;
+  // the change log is polled less often the longer no change is made, up to every 100 ms
+  int idle_ms = 1;
+  // at most 1 MB of changes is read at a time, unless a single change is longer
+  uintmax_t window = 1 << 20;
+
+  std::cout << "Replicating changes after change " << state.applied_seq << " (close the window to stop) ..." << std::endl;
+  while (true)
+  {
+    uintmax_t size = std::filesystem::exists(change_log) ? std::filesystem::file_size(change_log) : 0;
+    if (size < state.offset)
+    {
+      std::cout << "The change log of the primary database was replaced, delete the replica folder to initialize the replica again" << std::endl;
+      exit(1);
+    }
+
+    std::string data(std::min<uintmax_t>(size - state.offset, window), '\0');
+    std::ifstream f(change_log, std::ios::binary);
+    f.seekg(state.offset);
+    f.read(data.data(), data.size());
+    f.close();
+
+    size_t end_of_last_line = data.rfind('\n');
+    if (end_of_last_line == std::string::npos && data.size() == window)
+    {
+      // the window holds only part of a change, the read is retried with a larger window
+      window *= 2;
+      continue;
+    }
+
+    if (end_of_last_line == std::string::npos)
+    {
+      // caught up, the state is written again once a second so readers can tell the tool is running
+      if (state.lag_ms != 0 || now_ms() - last_state_write > 1000)
+      {
+        state.lag_ms = 0;
+        write_state(replica_filepath, state);
+        last_state_write = now_ms();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+      idle_ms = std::min(idle_ms * 2, 100);
+      continue;
+    }
+
+    idle_ms = 1;
+    window = 1 << 20;
+
+    for (size_t line_start = 0; line_start <= end_of_last_line;)
+    {
+      size_t line_end = data.find('\n', line_start);
+      Change change;
+      try
+      {
+        change = parse_change(data.substr(line_start, line_end - line_start));
+      }
+      catch (const std::exception&)
+      {
+        std::cout << "Malformed change at offset " << state.offset + line_start << " of " << change_log << std::endl;
+        exit(1);
+      }
+
+      if (change.seq > state.applied_seq)
+      {
+        apply_change(primary_filepath, replica_filepath, fieldnames, change);
+        state.applied_seq = change.seq;
+        state.lag_ms = std::max(0LL, now_ms() - change.ts);
+      }
+      line_start = line_end + 1;
+    }
+
+    state.offset += end_of_last_line + 1;
+    write_state(replica_filepath, state);
+    last_state_write = now_ms();
+  }
+}
+
+int main()
+{
+  std::string primary_filepath = get_folder("Primary database folder (e.g. ../database/): ");
+  std::string replica_filepath = get_folder("Replica database folder (e.g. ../replica/): ");
+  if (!std::filesystem::exists(primary_filepath + "table.info"))
+  {
+    std::cout << "Primary database has no tables" << std::endl;
+    exit(1);
+  }
+
+  try
+  {
+    ReplicaState state;
+    if (!read_state(replica_filepath, state))
+    {
+      if (std::filesystem::exists(replica_filepath))
+      {
+        std::cout << "Replica folder already exists and is not a replica" << std::endl;
+        exit(1);
+      }
+      state = initialize_replica(primary_filepath, replica_filepath);
+    }
+
+    replicate(primary_filepath, replica_filepath, state);
+  }
+  catch (const std::filesystem::filesystem_error& error)
+  {
+    std::cout << "Replication failed: " << error.what() << std::endl;
+    exit(1);
+  }
+}
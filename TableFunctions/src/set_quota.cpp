@@ -0,0 +1,56 @@
+#include "shared.hpp"
+
+/**
+ * @brief Replace the quotas in the table's record in the table.info file. The file is written to a temporary file which then replaces it,
+ * so the Table class never reads a partly written file. Connected databases use the new quotas once they connect again
+ * @return false if the table does not exist
+*/
+bool set_quota(std::string database_filepath, std::string table_name, std::string io_quota, std::string cpu_quota)
+{
+  std::string tables_info_file = database_filepath + "table.info";
+  std::ofstream f(tables_info_file + ".tmp");
+  bool found = false;
+
+  for (std::string record : read_table_info(database_filepath))
+  {
+    if (get_json_string(record, "name") != table_name)
+    {
+      f << record << std::endl;
+      continue;
+    }
+
+    found = true;
+    record = remove_json_key(remove_json_key(remove_json_key(record, "crc32c"), "io_quota"), "cpu_quota");
+    record = record.substr(0, record.size() - 1);
+    if (!io_quota.empty()) record += ",\"io_quota\":\"" + io_quota + "\"";
+    if (!cpu_quota.empty()) record += ",\"cpu_quota\":\"" + cpu_quota + "\"";
+    f << add_table_info_checksum(record + "}") << std::endl;
+  }
+
+  f.close();
+  if (found) std::filesystem::rename(tables_info_file + ".tmp", tables_info_file);
+  else std::filesystem::remove(tables_info_file + ".tmp");
+  return found;
+}
+
+int main()
+{
+  std::string database_filepath = get_database_filepath();
+  assert_database_folder_exists(database_filepath);
+
+  std::string table_name;
+  std::cout << "Name of the table to set the quotas of: ";
+  std::cin >> table_name;
+  std::cout << std::endl;
+
+  std::string io_quota = get_quota("I/O quota in bytes read and written per second (0 for no limit): ");
+  std::string cpu_quota = get_quota("CPU quota in milliseconds of processing per second (0 for no limit): ");
+
+  if (!set_quota(database_filepath, table_name, io_quota, cpu_quota))
+  {
+    std::cout << "Table does not exist" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Quotas of " << table_name << " set, they apply the next time the database is connected" << std::endl;
+}
@@ -3,6 +3,37 @@
 
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 std::string get_database_filepath()
 {
@@ -17,4 +48,1061 @@ void assert_database_folder_exists(std::string database_filepath)
   }
 }
 
-#endif
\ No newline at end of file
+/**
+ * @brief Check if a filename in a table folder is an entry, other files are temporary files of in-progress writes
+*/
+bool is_entry_filename(std::string filename)
+{
+  return !filename.empty() && std::all_of(filename.begin(), filename.end(), [](const char& c) -> bool { return isdigit(c); });
+}
+
+/**
+ * @brief Check if a folder in a partitioned table's folder is a partition, named "p" followed by the first value of the partition's range.
+ * Other folders are dropped partitions that are being removed
+*/
+bool is_partition_foldername(std::string foldername)
+{
+  if (foldername.size() < 2 || foldername[0] != 'p') return false;
+  return is_entry_filename(foldername.substr(foldername[1] == '-' ? 2 : 1));
+}
+
+/**
+ * @brief Check if a process writing to the database has a write in progress: the first byte of its marker file in the writes folder is 1 while it writes.
+ * The markers of processes that stopped without disconnecting are removed
+*/
+bool is_write_in_progress(std::string database_filepath)
+{
+  std::string writes_folder = database_filepath + "writes/";
+  if (!std::filesystem::is_directory(writes_folder)) return false;
+
+  for (const auto& marker : std::filesystem::directory_iterator(writes_folder))
+  {
+    std::ifstream f(marker.path(), std::ios::binary);
+    bool writing = f.get() == '1';
+    f.close();
+
+#if defined(__unix__) || defined(__APPLE__)
+    // markers are named "<process id>.<thread id>"
+    if (kill(std::atoi(marker.path().filename().string().c_str()), 0) != 0 && errno == ESRCH)
+    {
+      std::filesystem::remove(marker.path());
+      continue;
+    }
+#endif
+    if (writing) return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Creates the write freeze file when constructed and removes it when destroyed,
+ * so writes are unfrozen even if the tool holding the freeze fails.
+ * A write sets its marker before it checks for the freeze file, so once the freeze file exists the writes in progress are waited for
+ * and every later write sees the freeze
+*/
+struct WriteFreeze
+{
+  std::string freeze_file;
+
+  WriteFreeze(std::string database_filepath) : freeze_file(database_filepath + "snapshot.lock")
+  {
+    std::ofstream f(freeze_file);
+    f << std::time(nullptr) << std::endl;
+    f.close();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (is_write_in_progress(database_filepath))
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+      {
+        std::filesystem::remove(freeze_file);
+        throw std::filesystem::filesystem_error("Writes in progress did not finish within 10 seconds", database_filepath + "writes/", std::make_error_code(std::errc::timed_out));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  ~WriteFreeze()
+  {
+    std::filesystem::remove(freeze_file);
+  }
+};
+
+/**
+ * @brief CRC32C (Castagnoli) checksum of a buffer, one byte at a time
+*/
+uint32_t crc32c_software(const char* data, size_t length, uint32_t crc)
+{
+  static const std::vector<uint32_t> table = []()
+  {
+    std::vector<uint32_t> table(256);
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      uint32_t value = i;
+      for (int bit = 0; bit < 8; bit++) value = (value >> 1) ^ (0x82F63B78 & (0 - (value & 1)));
+      table[i] = value;
+    }
+    return table;
+  }();
+
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) crc = table[(crc ^ (uint8_t)data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_HARDWARE_SUPPORT
+
+/**
+ * @brief CRC32C (Castagnoli) checksum of a buffer, 8 bytes at a time using the SSE4.2 crc32 instruction
+*/
+__attribute__((target("sse4.2")))
+uint32_t crc32c_hardware(const char* data, size_t length, uint32_t crc)
+{
+  uint64_t crc64 = ~crc;
+  for (; length >= 8; data += 8, length -= 8)
+  {
+    uint64_t chunk;
+    std::memcpy(&chunk, data, 8);
+    crc64 = _mm_crc32_u64(crc64, chunk);
+  }
+
+  uint32_t crc32 = (uint32_t)crc64;
+  for (; length > 0; data++, length--) crc32 = _mm_crc32_u8(crc32, (uint8_t)*data);
+  return ~crc32;
+}
+#endif
+
+/**
+ * @brief CRC32C (Castagnoli) checksum of a buffer, using the crc32 instruction when the CPU supports it
+ * @param crc The checksum of the preceding data, to checksum a buffer in several parts
+*/
+uint32_t crc32c(const char* data, size_t length, uint32_t crc = 0)
+{
+#ifdef CRC32C_HARDWARE_SUPPORT
+  static const bool hardware_support = __builtin_cpu_supports("sse4.2");
+  if (hardware_support) return crc32c_hardware(data, length, crc);
+#endif
+  return crc32c_software(data, length, crc);
+}
+
+/**
+ * @brief Format a checksum the way it is stored in entry files and table.info, as 8 lowercase hex digits
+*/
+std::string format_checksum(uint32_t checksum)
+{
+  char formatted[9];
+  std::snprintf(formatted, sizeof(formatted), "%08x", checksum);
+  return formatted;
+}
+
+/**
+ * @brief Add a "crc32c" key to a table.info JSON record, holding the checksum of the record without the key
+*/
+std::string add_table_info_checksum(std::string record)
+{
+  return record.substr(0, record.size() - 1) + ",\"crc32c\":\"" + format_checksum(crc32c(record.data(), record.size())) + "\"}";
+}
+
+/**
+ * @brief Get the value of a string key in a JSON record, or an empty string if the key is missing
+ * @note Only for the records written by these tools and the Table class, whose strings contain no escaped quotes
+*/
+std::string get_json_string(std::string record, std::string key)
+{
+  size_t start = record.find("\"" + key + "\":\"");
+  if (start == std::string::npos) return "";
+  start += key.size() + 4;
+  return record.substr(start, record.find('"', start) - start);
+}
+
+/**
+ * @brief Get the strings of an array key in a JSON record, e.g. the fieldnames of a table.info record
+*/
+std::vector<std::string> get_json_string_array(std::string record, std::string key)
+{
+  std::vector<std::string> values;
+  size_t start = record.find("\"" + key + "\":[");
+  if (start == std::string::npos) return values;
+
+  size_t end = record.find(']', start);
+  for (size_t quote = record.find('"', start + key.size() + 4); quote < end; quote = record.find('"', quote + 1))
+  {
+    size_t closing_quote = record.find('"', quote + 1);
+    values.push_back(record.substr(quote + 1, closing_quote - quote - 1));
+    quote = closing_quote;
+  }
+
+  return values;
+}
+
+/**
+ * @brief Remove a string or array key from a JSON record
+*/
+std::string remove_json_key(std::string record, std::string key)
+{
+  size_t start = record.find(",\"" + key + "\":");
+  if (start == std::string::npos) return record;
+
+  size_t value_start = start + key.size() + 4;
+  size_t end = record[value_start] == '[' ? record.find(']', value_start) : record.find('"', value_start + 1);
+  return record.substr(0, start) + record.substr(end + 1);
+}
+
+/**
+ * @brief A change read from the change log of a database
+*/
+struct Change
+{
+  long long seq = 0;
+  long long ts = 0;
+  std::string table;
+  std::string id;
+  std::string op;
+  std::map<std::string, std::string> fields;
+};
+
+/**
+ * @brief Append the UTF-8 encoding of a code point to a string
+*/
+void append_utf8(std::string& value, uint32_t code_point)
+{
+  if (code_point < 0x80) value += (char)code_point;
+  else if (code_point < 0x800) value += { (char)(0xC0 | (code_point >> 6)), (char)(0x80 | (code_point & 0x3F)) };
+  else if (code_point < 0x10000) value += { (char)(0xE0 | (code_point >> 12)), (char)(0x80 | ((code_point >> 6) & 0x3F)), (char)(0x80 | (code_point & 0x3F)) };
+  else value += { (char)(0xF0 | (code_point >> 18)), (char)(0x80 | ((code_point >> 12) & 0x3F)), (char)(0x80 | ((code_point >> 6) & 0x3F)), (char)(0x80 | (code_point & 0x3F)) };
+}
+
+/**
+ * @brief Parse the JSON string starting at line[pos], and move pos past its closing quote
+ * @throws std::out_of_range if the string is not terminated
+*/
+std::string parse_json_string(const std::string& line, size_t& pos)
+{
+  std::string value;
+  for (pos++; line.at(pos) != '"'; pos++)
+  {
+    if (line[pos] != '\\')
+    {
+      value += line[pos];
+      continue;
+    }
+
+    char escape = line.at(++pos);
+    if (escape == 'n') value += '\n';
+    else if (escape == 'r') value += '\r';
+    else if (escape == 't') value += '\t';
+    else if (escape == 'b') value += '\b';
+    else if (escape == 'f') value += '\f';
+    else if (escape != 'u') value += escape;
+    else
+    {
+      uint32_t code_point = std::stoul(line.substr(pos + 1, 4), nullptr, 16);
+      pos += 4;
+      // a code point above U+FFFF is escaped as a pair of surrogates
+      if (code_point >= 0xD800 && code_point < 0xDC00 && line.compare(pos + 1, 2, "\\u") == 0)
+      {
+        uint32_t low_surrogate = std::stoul(line.substr(pos + 3, 4), nullptr, 16);
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+        pos += 6;
+      }
+      append_utf8(value, code_point);
+    }
+  }
+
+  pos++;
+  return value;
+}
+
+/**
+ * @brief Parse the JSON string, number or literal starting at line[pos], and move pos past it
+*/
+std::string parse_json_value(const std::string& line, size_t& pos)
+{
+  if (line.at(pos) == '"') return parse_json_string(line, pos);
+
+  size_t end = line.find_first_of(",}", pos);
+  std::string value = line.substr(pos, end - pos);
+  pos = end;
+  return value;
+}
+
+/**
+ * @brief Parse a line of the change log, as written by the ChangeLog class
+ * @throws std::out_of_range or std::invalid_argument if the line is malformed
+*/
+Change parse_change(const std::string& line)
+{
+  Change change;
+  size_t pos = 1;
+
+  while (line.at(pos) != '}')
+  {
+    if (line[pos] == ',') pos++;
+    std::string key = parse_json_string(line, pos);
+    pos++;
+
+    if (key != "fields")
+    {
+      std::string value = parse_json_value(line, pos);
+      if (key == "seq") change.seq = std::stoll(value);
+      else if (key == "ts") change.ts = std::stoll(value);
+      else if (key == "table") change.table = value;
+      else if (key == "id") change.id = value;
+      else if (key == "op") change.op = value;
+      continue;
+    }
+
+    for (pos++; line.at(pos) != '}';)
+    {
+      if (line[pos] == ',') pos++;
+      std::string fieldname = parse_json_string(line, pos);
+      pos++;
+      change.fields[fieldname] = parse_json_value(line, pos);
+    }
+    pos++;
+  }
+
+  return change;
+}
+
+/**
+ * @brief Read the sequence number of the last change before the given position in the change log
+*/
+long long read_seq_before(std::string change_log, uintmax_t offset)
+{
+  std::ifstream f(change_log, std::ios::binary);
+  // read a larger part of the log before the offset until it contains the whole last line
+  for (uintmax_t length = 4096; ; length *= 2)
+  {
+    uintmax_t start = offset > length ? offset - length : 0;
+    std::string data(offset - start, '\0');
+    f.seekg(start);
+    f.read(data.data(), data.size());
+
+    size_t line_start = data.size() >= 2 ? data.rfind('\n', data.size() - 2) : std::string::npos;
+    if (line_start == std::string::npos && start > 0) continue;
+    if (data.empty()) return 0;
+    return parse_change(data.substr(line_start == std::string::npos ? 0 : line_start + 1)).seq;
+  }
+}
+
+/**
+ * @brief Read the records of the table.info file of a database
+*/
+std::vector<std::string> read_table_info(std::string database_filepath)
+{
+  std::vector<std::string> records;
+  std::ifstream f(database_filepath + "table.info");
+  std::string line;
+
+  while (std::getline(f, line))
+  {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty()) records.push_back(line);
+  }
+
+  return records;
+}
+
+/**
+ * @brief Get the folders where a table's entries are stored: one per shard for a sharded table, one per partition for a partitioned table,
+ * otherwise the table's folder in the database folder
+ * @param record The table's table.info record
+*/
+std::vector<std::string> get_table_folders(std::string database_filepath, std::string record)
+{
+  std::string name = get_json_string(record, "name");
+  std::vector<std::string> folders;
+
+  if (!get_json_string(record, "partition_key").empty())
+  {
+    std::string table_folder = database_filepath + name + "/";
+    if (!std::filesystem::is_directory(table_folder)) return folders;
+
+    for (const auto& partition : std::filesystem::directory_iterator(table_folder))
+    {
+      if (partition.is_directory() && is_partition_foldername(partition.path().filename().string())) folders.push_back(partition.path().string() + "/");
+    }
+    std::sort(folders.begin(), folders.end());
+    return folders;
+  }
+
+  for (std::string root : get_json_string_array(record, "shards")) folders.push_back(root + name + "/");
+  if (folders.empty()) folders.push_back(database_filepath + name + "/");
+  return folders;
+}
+
+/**
+ * @brief Write the table.info file of a copy of the database (a snapshot, backup or replica).
+ * The copy stores every table in a single folder, so the shards and partitions of tables are removed from their records.
+ * Indexes are removed too, as index files are kept up to date only in the database they were built in
+*/
+void copy_table_info_flat(std::string database_filepath, std::string copy_filepath)
+{
+  std::ofstream f(copy_filepath + "table.info");
+  for (std::string record : read_table_info(database_filepath))
+  {
+    std::string flat_record = remove_json_key(record, "crc32c");
+    std::string unchecksummed_record = flat_record;
+    for (std::string key : { "shards", "shard_key", "partition_key", "partition_width", "indexes" }) flat_record = remove_json_key(flat_record, key);
+
+    if (flat_record == unchecksummed_record) f << record << std::endl;
+    else f << add_table_info_checksum(flat_record) << std::endl;
+  }
+}
+
+/**
+ * @brief Format the contents of an entry file the same way the Table class does: one field per line, then the checksum of the fields
+*/
+std::string format_entry(const std::vector<std::string>& values)
+{
+  std::string fields;
+  for (size_t i = 0; i < values.size(); i++) fields += (i == 0 ? "" : "\n") + values[i];
+  return fields + "\ncrc32c:" + format_checksum(crc32c(fields.data(), fields.size()));
+}
+
+/**
+ * @brief Whether scans read entry files with direct I/O, set by the tools that scan every entry of the database when the user asks for it
+*/
+bool direct_io = false;
+
+/**
+ * @brief Ask the user whether to read the entries with direct I/O, which bypasses the page cache entirely.
+ * Used for scans of databases much larger than memory, which then neither evict nor depend on cached pages
+*/
+void ask_direct_io()
+{
+  std::string answer;
+  std::cout << "Read entries with direct I/O, bypassing the page cache? (y/n): ";
+  std::cin >> answer;
+  std::cout << std::endl;
+  direct_io = answer == "y";
+}
+
+#if defined(O_DIRECT)
+/**
+ * @brief Read a whole file with O_DIRECT, into a buffer aligned to the block size of the disk as direct I/O requires
+ * @return false if the file cannot be opened or its file system does not support direct I/O
+*/
+bool read_file_direct(std::string path, std::string& contents)
+{
+  const size_t block_size = 4096;
+  int fd = open(path.c_str(), O_RDONLY | O_DIRECT);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // reads are whole blocks, so the buffer is rounded up and always has room for the short read at the end of the file
+  size_t capacity = (info.st_size / block_size + 1) * block_size;
+  char* buffer = static_cast<char*>(std::aligned_alloc(block_size, capacity));
+  size_t length = 0;
+  ssize_t n = 0;
+  while (length < capacity && (n = pread(fd, buffer + length, capacity - length, length)) > 0) length += n;
+
+  if (n >= 0) contents.assign(buffer, length);
+  std::free(buffer);
+  close(fd);
+  return n >= 0;
+}
+#endif
+
+/**
+ * @brief Read a whole file that a scan reads once. Where posix_fadvise is available, the kernel is told the file is read sequentially
+ * and then that its pages are no longer needed, so scanning every entry of the database does not push the entries read by the Table class out of the page cache
+ * With direct_io set, the file is read with O_DIRECT where the platform and file system support it
+ * @return The contents of the file, or an empty string if it cannot be opened
+*/
+std::string read_file_once(std::string path)
+{
+#if defined(O_DIRECT)
+  std::string direct_contents;
+  if (direct_io && read_file_direct(path, direct_contents)) return direct_contents;
+#endif
+
+#if defined(POSIX_FADV_DONTNEED)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return "";
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  std::string contents;
+  char buffer[65536];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) contents.append(buffer, n);
+
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  return contents;
+#else
+  std::ifstream f(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+#endif
+}
+
+/**
+ * @brief Get the fields of an entry from the contents of its file, without its checksum line
+*/
+std::vector<std::string> parse_entry(const std::string& contents, size_t field_count)
+{
+  std::vector<std::string> values;
+  std::istringstream f(contents);
+  std::string line;
+  while (values.size() < field_count && std::getline(f, line)) values.push_back(line);
+  return values;
+}
+
+/**
+ * @brief Read the fields of an entry file, without its checksum line
+*/
+std::vector<std::string> read_entry(std::string path, size_t field_count)
+{
+  std::vector<std::string> values;
+  std::ifstream f(path, std::ios::binary);
+  std::string line;
+  while (values.size() < field_count && std::getline(f, line)) values.push_back(line);
+  return values;
+}
+
+/**
+ * @brief CRC32C checksum of a whole file
+*/
+uint32_t file_crc32c(std::string path)
+{
+  std::string contents = read_file_once(path);
+  return crc32c(contents.data(), contents.size());
+}
+
+/**
+ * @brief Call fn(i) for every i in [0, count) using one thread per core
+ * @note fn must not throw
+*/
+void parallel_for(size_t count, std::function<void(size_t)> fn)
+{
+  size_t thread_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count));
+  std::atomic<size_t> next = 0;
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < thread_count; t++)
+  {
+    threads.emplace_back([&]()
+    {
+      for (size_t i = next++; i < count; i = next++) fn(i);
+    });
+  }
+
+  for (std::thread& thread : threads) thread.join();
+}
+
+/**
+ * @brief A bounded queue between one producer thread and one consumer thread, which never locks:
+ * each side only writes its own end of the queue, and publishes it with a release store the other side reads with an acquire load
+*/
+template <typename T>
+struct SpscQueue
+{
+  std::vector<T> slots;
+  alignas(64) std::atomic<size_t> head = 0;
+  alignas(64) std::atomic<size_t> tail = 0;
+  std::atomic<bool> closed = false;
+
+  // one slot is always left empty, so a full queue can be told apart from an empty one
+  SpscQueue(size_t capacity) : slots(capacity + 1) {}
+
+  /**
+   * @brief Add a value to the queue, waiting while the queue is full
+  */
+  void push(T value)
+  {
+    size_t position = tail.load(std::memory_order_relaxed);
+    size_t next = (position + 1) % slots.size();
+    while (next == head.load(std::memory_order_acquire)) std::this_thread::yield();
+    slots[position] = std::move(value);
+    tail.store(next, std::memory_order_release);
+  }
+
+  /**
+   * @brief Take the oldest value from the queue, waiting while the queue is empty
+   * @return false if the queue is empty and closed by the producer
+  */
+  bool pop(T& value)
+  {
+    size_t position = head.load(std::memory_order_relaxed);
+    while (position == tail.load(std::memory_order_acquire))
+    {
+      // values pushed before the queue was closed are still taken
+      if (closed.load(std::memory_order_acquire) && position == tail.load(std::memory_order_acquire)) return false;
+      std::this_thread::yield();
+    }
+    value = std::move(slots[position]);
+    head.store((position + 1) % slots.size(), std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Tell the consumer no more values will be pushed
+  */
+  void close()
+  {
+    closed.store(true, std::memory_order_release);
+  }
+};
+
+/**
+ * @brief A token bucket limiting the rate a scan uses a resource at, shared by the threads of the scan.
+ * The bucket is refilled at a fixed rate and holds at most one second of tokens, so a table that was idle can burst for a second
+*/
+struct TokenBucket
+{
+  double rate;
+  double tokens;
+  std::chrono::steady_clock::time_point last_refill = std::chrono::steady_clock::now();
+  std::mutex lock;
+  std::atomic<long long> throttled_ms = 0;
+
+  /**
+   * @param rate The tokens added per second, 0 for no limit
+  */
+  TokenBucket(double rate) : rate(rate), tokens(rate) {}
+
+  /**
+   * @brief Take tokens from the bucket, then wait until the bucket is no longer in debt.
+   * The tokens are always taken, so a file larger than the bucket is read once and paid for by waiting longer
+  */
+  void take(double amount)
+  {
+    if (rate == 0) return;
+
+    double debt;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      auto now = std::chrono::steady_clock::now();
+      tokens = std::min(rate, tokens + std::chrono::duration<double>(now - last_refill).count() * rate);
+      last_refill = now;
+      tokens -= amount;
+      debt = -tokens;
+    }
+
+    if (debt <= 0) return;
+    long long wait_ms = (long long)std::ceil(debt * 1000 / rate);
+    throttled_ms += wait_ms;
+    std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
+  }
+};
+
+/**
+ * @brief Get a quota of a table from its table.info record, 0 if the table has none
+ * @param key "io_quota" for the bytes read per second, or "cpu_quota" for the milliseconds of processing per second
+*/
+double get_table_quota(std::string record, std::string key)
+{
+  std::string quota = get_json_string(record, key);
+  return quota.empty() ? 0 : std::stod(quota);
+}
+
+/**
+ * @brief Ask for a quota of the table, enforced with a token bucket by the Table class and the tools that scan the table
+ * @param prompt The question asked, naming the resource and its unit
+ * @return The quota as a string of digits, or an empty string for no limit
+*/
+std::string get_quota(std::string prompt)
+{
+  std::string quota;
+  std::cout << prompt;
+  std::cin >> quota;
+  std::cout << std::endl;
+
+  if (quota.empty() || any_of(quota.begin(), quota.end(), [](const char& c) -> bool { return !isdigit(c); }))
+  {
+    std::cout << "Quota must be a number" << std::endl;
+    exit(1);
+  }
+
+  return std::stoll(quota) == 0 ? "" : quota;
+}
+
+/**
+ * @brief The I/O and CPU quotas of a table, enforced on scans of the table the same way the Table class enforces them on reads
+*/
+struct TableQuota
+{
+  TokenBucket io;
+  TokenBucket cpu;
+
+  TableQuota(std::string record) : io(get_table_quota(record, "io_quota")), cpu(get_table_quota(record, "cpu_quota")) {}
+};
+
+/**
+ * @brief Read every file and call fn(i, contents) for the contents of files[i], with the reads running ahead of the calls.
+ * Each core gets a pipeline of two threads: a reader that reads up to read_ahead files ahead with read_file_once,
+ * and a worker that decodes and checks them, so the disk is kept busy while the entries already read are processed
+ * @param quota The quotas of the scanned table: the readers are charged the bytes read and the workers the time spent in fn
+ * @note fn must not throw
+*/
+void scan_files(const std::vector<std::filesystem::path>& files, std::function<void(size_t, std::string&)> fn, TableQuota* quota = nullptr, size_t read_ahead = 64)
+{
+  size_t pipeline_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), files.size()));
+  std::atomic<size_t> next = 0;
+  std::vector<std::unique_ptr<SpscQueue<std::pair<size_t, std::string>>>> queues;
+  std::vector<std::thread> threads;
+
+  for (size_t p = 0; p < pipeline_count; p++)
+  {
+    queues.push_back(std::make_unique<SpscQueue<std::pair<size_t, std::string>>>(read_ahead));
+    SpscQueue<std::pair<size_t, std::string>>& queue = *queues.back();
+
+    threads.emplace_back([&]()
+    {
+      for (size_t i = next++; i < files.size(); i = next++)
+      {
+        std::string contents = read_file_once(files[i].string());
+        if (quota) quota->io.take(contents.size());
+        queue.push({ i, std::move(contents) });
+      }
+      queue.close();
+    });
+
+    threads.emplace_back([&]()
+    {
+      std::pair<size_t, std::string> file;
+      while (queue.pop(file))
+      {
+        auto start = std::chrono::steady_clock::now();
+        fn(file.first, file.second);
+        if (quota) quota->cpu.take(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+      }
+    });
+  }
+
+  for (std::thread& thread : threads) thread.join();
+}
+
+/**
+ * @brief Hard-link an entry file into the snapshot, or copy it if the file system does not support hard links
+ * @return true if the entry was hard-linked, false if it was copied
+*/
+bool link_entry(const std::filesystem::path& entry, const std::filesystem::path& snapshot_entry)
+{
+  std::error_code error;
+  std::filesystem::create_hard_link(entry, snapshot_entry, error);
+  if (!error) return true;
+
+  std::filesystem::copy_file(entry, snapshot_entry);
+  return false;
+}
+
+/**
+ * @brief Snapshot every table and the table.info file of the database.
+ * The entries of every shard or partition of a table are stored together in the snapshot's table folder
+ * @note Entry files are never modified in place (writes replace them with a new file),
+ * so a hard link keeps the entry as it was when the snapshot was taken without copying it
+ * @param unlinked If given, the entries that cannot be hard-linked are added to it with their path in the snapshot instead of being copied,
+ * for a caller that copies them once writes resume
+*/
+void snapshot_database(std::string database_filepath, std::string snapshot_path, std::vector<std::pair<std::filesystem::path, std::filesystem::path>>* unlinked = nullptr)
+{
+  std::filesystem::create_directories(snapshot_path);
+
+  // table.info is rewritten in place by delete_table, so it is copied instead of linked
+  copy_table_info_flat(database_filepath, snapshot_path);
+
+  size_t linked = 0, copied = 0;
+  std::ofstream manifest(snapshot_path + "snapshot.info");
+  manifest << "created " << std::time(nullptr) << std::endl;
+
+  // Changes after this position in the change log were made after the snapshot was taken
+  std::string change_log = database_filepath + "changes.log";
+  manifest << "changes_offset " << (std::filesystem::exists(change_log) ? std::filesystem::file_size(change_log) : 0) << std::endl;
+
+  for (std::string record : read_table_info(database_filepath))
+  {
+    std::string table_name = get_json_string(record, "name");
+    std::filesystem::create_directory(snapshot_path + table_name);
+
+    size_t entries = 0;
+    for (std::string folder : get_table_folders(database_filepath, record))
+    {
+      if (!std::filesystem::is_directory(folder)) continue;
+
+      for (const auto& entry : std::filesystem::directory_iterator(folder))
+      {
+        if (!is_entry_filename(entry.path().filename().string())) continue;
+        std::filesystem::path snapshot_entry = snapshot_path + table_name + "/" + entry.path().filename().string();
+        entries++;
+
+        if (!unlinked)
+        {
+          if (link_entry(entry.path(), snapshot_entry)) linked++;
+          else copied++;
+          continue;
+        }
+
+        std::error_code error;
+        std::filesystem::create_hard_link(entry.path(), snapshot_entry, error);
+        if (error) unlinked->push_back({ entry.path(), snapshot_entry });
+        else linked++;
+      }
+    }
+
+    manifest << "table " << table_name << " " << entries << std::endl;
+  }
+
+  manifest.close();
+  std::cout << linked << " entries linked, " << copied + (unlinked ? unlinked->size() : 0) << " entries copied" << std::endl;
+}
+
+/**
+ * @brief A key of a secondary index: the value of the indexed field of an entry, and the entry's id
+*/
+struct IndexKey
+{
+  std::string value;
+  double number;
+  long long id;
+};
+
+/**
+ * @brief Parse the number at the start of a value the same way JavaScript's parseFloat does
+ * @return The number, or NaN if the value does not start with a number
+*/
+double parse_float(const std::string& value)
+{
+  size_t start = value.find_first_not_of(" \t\n\r\f\v");
+  if (start == std::string::npos) return NAN;
+
+  size_t pos = start;
+  if (value[pos] == '+' || value[pos] == '-') pos++;
+  if (value.compare(pos, 8, "Infinity") == 0) return value[start] == '-' ? -INFINITY : INFINITY;
+
+  // strtod also accepts hex numbers and "inf", so only the digits, fraction and exponent are passed to it
+  size_t digits = 0;
+  for (; pos < value.size() && isdigit(value[pos]); pos++) digits++;
+  if (pos < value.size() && value[pos] == '.') for (pos++; pos < value.size() && isdigit(value[pos]); pos++) digits++;
+  if (digits == 0) return NAN;
+
+  if (pos < value.size() && (value[pos] == 'e' || value[pos] == 'E'))
+  {
+    size_t exponent = pos + 1;
+    if (exponent < value.size() && (value[exponent] == '+' || value[exponent] == '-')) exponent++;
+    if (exponent < value.size() && isdigit(value[exponent])) for (pos = exponent; pos < value.size() && isdigit(value[pos]); pos++);
+  }
+
+  return std::strtod(value.substr(start, pos - start).c_str(), nullptr);
+}
+
+/**
+ * @brief Order index keys the same way the Table class does: numbers first in numeric order, then other values in string order, then by id
+*/
+bool index_key_less(const IndexKey& a, const IndexKey& b)
+{
+  bool a_numeric = !std::isnan(a.number), b_numeric = !std::isnan(b.number);
+  if (a_numeric != b_numeric) return a_numeric;
+  if (a_numeric && a.number != b.number) return a.number < b.number;
+  if (a.value != b.value) return a.value < b.value;
+  return a.id < b.id;
+}
+
+/**
+ * @brief Sort index keys with one thread per core: each thread sorts a run of the keys, then neighbouring runs are merged in parallel until one run is left
+*/
+void parallel_sort(std::vector<IndexKey>& keys)
+{
+  size_t run_count = std::max(1u, std::thread::hardware_concurrency());
+  size_t run_length = std::max<size_t>(1, (keys.size() + run_count - 1) / run_count);
+  std::vector<size_t> bounds;
+  for (size_t start = 0; start < keys.size(); start += run_length) bounds.push_back(start);
+  bounds.push_back(keys.size());
+
+  parallel_for(bounds.size() - 1, [&](size_t i) { std::sort(keys.begin() + bounds[i], keys.begin() + bounds[i + 1], index_key_less); });
+
+  while (bounds.size() > 2)
+  {
+    parallel_for((bounds.size() - 1) / 2, [&](size_t i)
+    {
+      std::inplace_merge(keys.begin() + bounds[2 * i], keys.begin() + bounds[2 * i + 1], keys.begin() + bounds[2 * i + 2], index_key_less);
+    });
+
+    std::vector<size_t> merged_bounds;
+    for (size_t i = 0; i < bounds.size() - 1; i += 2) merged_bounds.push_back(bounds[i]);
+    merged_bounds.push_back(keys.size());
+    bounds = merged_bounds;
+  }
+}
+
+/**
+ * @brief Read the indexed field of every entry of the table, reading the entries ahead of parsing them on every core.
+ * The scan is held to the table's I/O and CPU quotas, so building an index does not take the disk from the other tables
+*/
+std::vector<IndexKey> scan_table(std::string database_filepath, std::string record, size_t field_index)
+{
+  TableQuota quota(record);
+  std::vector<std::filesystem::path> entries;
+  for (std::string folder : get_table_folders(database_filepath, record))
+  {
+    if (!std::filesystem::is_directory(folder)) continue;
+    for (const auto& file : std::filesystem::directory_iterator(folder))
+    {
+      if (is_entry_filename(file.path().filename().string())) entries.push_back(file.path());
+    }
+  }
+
+  std::vector<IndexKey> keys(entries.size());
+  std::vector<char> found(entries.size(), 0);
+  scan_files(entries, [&](size_t i, std::string& contents)
+  {
+    // an entry deleted since the folder was listed is skipped, its deletion is in the change log
+    std::vector<std::string> values = parse_entry(contents, field_index + 1);
+    if (values.size() <= field_index) return;
+    keys[i] = { values[field_index], parse_float(values[field_index]), std::stoll(entries[i].filename().string()) };
+    found[i] = 1;
+  }, &quota);
+
+  if (quota.io.throttled_ms || quota.cpu.throttled_ms)
+  {
+    std::cout << "Scan throttled by the table's quotas for " << quota.io.throttled_ms << " ms (I/O) and " << quota.cpu.throttled_ms << " ms (CPU)" << std::endl;
+  }
+
+  std::vector<IndexKey> found_keys;
+  for (size_t i = 0; i < keys.size(); i++) if (found[i]) found_keys.push_back(std::move(keys[i]));
+  return found_keys;
+}
+
+/**
+ * @brief Read the changes to the table written to the change log since the scan started, until the end of the log is reached
+ * @param offset The position in the change log to read from, moved to the end of the last change read
+ * @param seq The sequence number of the last change already in the index, updated to the last change read
+ * @return The latest value of the indexed field of every changed entry, or no value if the entry was deleted
+*/
+std::map<long long, std::optional<std::string>> read_changes(std::string change_log, std::string table_name, std::string fieldname, uintmax_t& offset, long long& seq)
+{
+  std::map<long long, std::optional<std::string>> changes;
+  std::ifstream f(change_log, std::ios::binary);
+  f.seekg(offset);
+  std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+  // a partly written last line is read once it is complete, on the next call
+  size_t end = data.rfind('\n');
+  if (end == std::string::npos) return changes;
+
+  for (size_t line_start = 0; line_start <= end;)
+  {
+    size_t line_end = data.find('\n', line_start);
+    Change change = parse_change(data.substr(line_start, line_end - line_start));
+    line_start = line_end + 1;
+    if (change.seq <= seq) continue;
+    seq = change.seq;
+    if (change.table != table_name) continue;
+
+    long long id = std::stoll(change.id);
+    auto field = change.fields.find(fieldname);
+    if (change.op == "delete") changes[id] = std::nullopt;
+    else if (field != change.fields.end()) changes[id] = field->second;
+  }
+
+  offset += end + 1;
+  return changes;
+}
+
+/**
+ * @brief Apply changes read from the change log to the sorted keys of the index, keeping them sorted
+*/
+void apply_changes(std::vector<IndexKey>& keys, const std::map<long long, std::optional<std::string>>& changes)
+{
+  keys.erase(std::remove_if(keys.begin(), keys.end(), [&](const IndexKey& key) -> bool { return changes.count(key.id) != 0; }), keys.end());
+
+  std::vector<IndexKey> changed_keys;
+  for (const auto& [id, value] : changes)
+  {
+    if (value) changed_keys.push_back({ *value, parse_float(*value), id });
+  }
+  std::sort(changed_keys.begin(), changed_keys.end(), index_key_less);
+
+  std::vector<IndexKey> merged;
+  merged.reserve(keys.size() + changed_keys.size());
+  std::merge(keys.begin(), keys.end(), changed_keys.begin(), changed_keys.end(), std::back_inserter(merged), index_key_less);
+  keys = std::move(merged);
+}
+
+/**
+ * @brief Write the index file: the sequence number of the last change included in the index and the position after it in the change log,
+ * then the sorted keys one per line. The index is written to a temporary file which then replaces the index file, so readers never see a partly written index
+*/
+void write_index(std::string index_path, const std::vector<IndexKey>& keys, long long seq, uintmax_t offset)
+{
+  std::ofstream f(index_path + ".tmp", std::ios::binary);
+  f << "seq " << seq << " " << offset << "\n";
+  for (const IndexKey& key : keys) f << key.id << " " << key.value << "\n";
+  f.close();
+  std::filesystem::rename(index_path + ".tmp", index_path);
+}
+
+/**
+ * @brief Add the index to the table's record in the table.info file, which is replaced the same way as the index file
+*/
+void publish_index(std::string database_filepath, std::string table_name, std::string fieldname)
+{
+  std::string tables_info_file = database_filepath + "table.info";
+  std::ofstream f(tables_info_file + ".tmp");
+
+  for (std::string record : read_table_info(database_filepath))
+  {
+    std::vector<std::string> indexes = get_json_string_array(record, "indexes");
+    if (get_json_string(record, "name") != table_name || std::find(indexes.begin(), indexes.end(), fieldname) != indexes.end())
+    {
+      f << record << std::endl;
+      continue;
+    }
+
+    indexes.push_back(fieldname);
+    std::string formatted_indexes;
+    for (size_t i = 0; i < indexes.size(); i++) formatted_indexes += (i == 0 ? "\"" : ",\"") + indexes[i] + "\"";
+
+    record = remove_json_key(remove_json_key(record, "crc32c"), "indexes");
+    f << add_table_info_checksum(record.substr(0, record.size() - 1) + ",\"indexes\":[" + formatted_indexes + "]}") << std::endl;
+  }
+
+  f.close();
+  std::filesystem::rename(tables_info_file + ".tmp", tables_info_file);
+}
+
+/**
+ * @brief Build an index of a field of a table without freezing writes: the table is scanned and sorted in parallel,
+ * then the writes made during the build are read from the change log and merged into the index before it is published.
+ * The Table class applies the changes made after the index file was written when it loads the index
+*/
+void build_index(std::string database_filepath, std::string record, std::string fieldname, size_t field_index)
+{
+  std::string table_name = get_json_string(record, "name");
+  std::string change_log = database_filepath + "changes.log";
+
+  // changes after this position in the change log may have been made after their entry was scanned
+  uintmax_t offset = std::filesystem::exists(change_log) ? std::filesystem::file_size(change_log) : 0;
+  long long seq = read_seq_before(change_log, offset);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<IndexKey> keys = scan_table(database_filepath, record, field_index);
+  std::cout << keys.size() << " entries scanned" << std::endl;
+  parallel_sort(keys);
+
+  size_t caught_up = 0;
+  while (true)
+  {
+    std::map<long long, std::optional<std::string>> changes = read_changes(change_log, table_name, fieldname, offset, seq);
+    if (changes.empty()) break;
+    apply_changes(keys, changes);
+    caught_up += changes.size();
+  }
+  std::cout << caught_up << " entries changed during the build were applied" << std::endl;
+
+  write_index(database_filepath + table_name + "." + fieldname + ".index", keys, seq, offset);
+  publish_index(database_filepath, table_name, fieldname);
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Index of " << table_name << "." << fieldname << " built in " << elapsed << " ms, up to change " << seq << std::endl;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "shared.hpp"
+
+/**
+ * @brief Get the folder where snapshots are stored
+*/
+std::string get_snapshots_filepath()
+{
+  return "../snapshots/";
+}
+
+/**
+ * @brief Get the name of the snapshot to create
+*/
+std::string get_snapshot_name()
+{
+  std::string snapshot_name;
+  std::cout << "Name your snapshot: ";
+  std::cin >> snapshot_name;
+  std::cout << std::endl;
+
+  // Check if snapshot_name is not alphanumeric
+  if (std::any_of(snapshot_name.begin(), snapshot_name.end(), [](const char& c) -> bool { return c != '_' && c != '-' && !isalnum(c); }))
+  {
+    std::cout << "Snapshot name must be alphanumeric" << std::endl;
+    exit(1);
+  }
+
+  return snapshot_name;
+}
+
+int main()
+{
+  std::string database_filepath = get_database_filepath();
+  assert_database_folder_exists(database_filepath);
+
+  std::string snapshot_path = get_snapshots_filepath() + get_snapshot_name() + "/";
+  if (std::filesystem::exists(snapshot_path))
+  {
+    std::cout << "Snapshot already exists" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Taking snapshot ..." << std::endl;
+  try
+  {
+    WriteFreeze freeze(database_filepath);
+    snapshot_database(database_filepath, snapshot_path);
+  }
+  catch (const std::filesystem::filesystem_error& error)
+  {
+    std::cout << "Snapshot failed: " << error.what() << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Snapshot created successfully in " << snapshot_path << std::endl;
+}
@@ -1,4 +1,7 @@
 const fs = require('fs');
+const net = require('net');
+const worker_threads = require('worker_threads');
+const { EventEmitter } = require('events');
 
 /**
  * Example of a database-entry record. Note the TEntry type is a Record<fieldname, fieldvalue>
@@ -51,6 +54,49 @@ export type TEntriesFilter = (entry: TEntry) => boolean;
  */
 export type TParseEntryFieldsFunction = (entry: TEntry) => any;
 
+/**
+ * A change made to a table entry, as recorded in the change log
+ */
+export type TChange = {
+  /**
+   * The position of the change in the change log, starting at 1 and increasing by 1 for every change
+   */
+  readonly seq: number;
+
+  /**
+   * The time the change was made, in milliseconds since the epoch
+   */
+  readonly ts: number;
+  readonly table: string;
+  readonly id: entryid;
+  readonly op: "post" | "patch" | "delete";
+
+  /**
+   * Every field of a posted entry, the updated fields of a patched entry, or no fields for a deleted entry
+   */
+  readonly fields: TEntry;
+}
+
+/**
+ * The state of a replica database, as reported by the replicate_db tool
+ */
+export type TReplicationStatus = {
+  /**
+   * The sequence number of the last change of the primary database applied to the replica
+   */
+  readonly applied_seq: number;
+
+  /**
+   * How long after it was made on the primary database the last change was applied to the replica, in milliseconds. 0 when the replica is caught up
+   */
+  readonly lag_ms: number;
+
+  /**
+   * The time the replicate_db tool last reported its state, in milliseconds since the epoch
+   */
+  readonly updated_at: number;
+}
+
 /**
  * Raw JSON table type
  */
@@ -58,1579 +104,5847 @@ type TRawTable = {
   readonly name: string;
   readonly folder: string;
   readonly fieldnames: Array<fieldname>;
+
+  /**
+   * The root folders of a sharded table's shards, the entries of a shard are stored in the table-named folder inside its root folder
+   */
+  readonly shards?: Array<string>;
+
+  /**
+   * The field whose value decides the shard an entry is stored in, "id" if missing
+   */
+  readonly shard_key?: fieldname;
+
+  /**
+   * The field whose value decides the partition an entry is stored in, the partitions are folders inside the table's folder
+   */
+  readonly partition_key?: fieldname;
+
+  /**
+   * The number of partition key values each partition holds, as a string of digits
+   */
+  readonly partition_width?: string;
+
+  /**
+   * The field holding the time an entry expires at, in milliseconds since the epoch
+   */
+  readonly ttl_field?: fieldname;
+
+  /**
+   * The fields with an index built by the build_index tool, stored in the "<table>.<field>.index" files of the database folder
+   */
+  readonly indexes?: Array<fieldname>;
+
+  /**
+   * The bytes of entry files the table reads and writes per second, as a string of digits. Missing if the table has no I/O quota
+   */
+  readonly io_quota?: string;
+
+  /**
+   * The milliseconds per second the table spends decoding entries and evaluating predicates, as a string of digits. Missing if the table has no CPU quota
+   */
+  readonly cpu_quota?: string;
+
+  /**
+   * "true" if every entry of the table ends with a checksum line, as for tables created since checksums were added.
+   * Missing for older tables, whose entries written before then have no checksum line
+   */
+  readonly checksummed?: string;
 }
 
 /**
- * Database Table
+ * Counters of the entry cache, see Database.get_cache_stats()
  */
-export class Table {
+export type TCacheStats = {
   /**
-   * The name of the table
+   * The memory budget of the cache in bytes, 0 if the cache is disabled
    */
-  public readonly name: string;
+  readonly budget: number;
 
   /**
-   * The path to the folder where the table's entries are stored
+   * The estimated memory used by the cached entries in bytes
    */
-  private readonly folder: string;
+  readonly bytes: number;
+  readonly entries: number;
+  readonly hits: number;
+  readonly misses: number;
+  readonly evictions: number;
+}
 
+/**
+ * Counters of the quotas of a table, see Database.get_quota_stats()
+ */
+export type TQuotaStats = {
   /**
-   * The names of the fields in the table / in the table's entries
+   * The I/O quota in bytes per second and the CPU quota in milliseconds per second, 0 if the table has no such quota
    */
-  private readonly fieldnames: Array<fieldname>;
+  readonly io_quota: number;
+  readonly cpu_quota: number;
 
   /**
-   * Function for parsing table entries, as all fields are by default unparsed strings and might need to be converted to numbers, booleans, dates, a class instance, etc.
+   * The bytes of entry files read and written, and the milliseconds spent decoding entries and evaluating predicates, since the database was connected
    */
-  private parseFunction: TParseEntryFieldsFunction;
+  readonly io_bytes: number;
+  readonly cpu_ms: number;
 
   /**
-   * Create a table from a raw json table stored in the table.info file
-   * @important This constructor is not meant to be used directly, all tables are instantiated when the Database.connect() method is called
-   * @param raw_table The raw json table from the table.info file
+   * How many times a read or write waited for the table's quotas, and how long the table was waiting in total
    */
-  constructor(raw_table: TRawTable) {
-    this.name = raw_table.name;
-    this.folder = `./database/${raw_table.name}/`;
-    this.fieldnames = raw_table.fieldnames;
-    // by default, the parseFunction will return the entry without parsing it
-    this.parseFunction = (entry: TEntry): TEntry => entry;
+  readonly throttled: number;
+  readonly throttled_ms: number;
+}
+
+/**
+ * An entry read from its file, with its id and the path to the file
+ */
+type TStoredEntry = {
+  readonly id: entryid;
+  readonly path: string;
+  readonly entry: TEntry;
+}
+
+/**
+ * A row of a join of two tables: an entry of the left table and an entry of the right table whose fields are equal
+ */
+export type TJoinedRow<L = TEntry, R = TEntry> = {
+  readonly left: L;
+  readonly right: R;
+}
+
+/**
+ * How a join finds the right entries of the left entries: by looking up every distinct value in the right table's index,
+ * or by scanning the right table into a hash table of the values
+ */
+type TJoinStrategy = "index nested-loop" | "hash";
+
+/**
+ * A comparison of a field with a value that can be answered by an index and used to prune partitions.
+ * "==" compares strings, the other comparisons compare the field parsed as a number
+ */
+type TComparison = "==" | ">" | "<" | ">=" | "<=";
+
+/**
+ * A key of a secondary index: the value of the indexed field of an entry, the value parsed as a number, and the entry's id
+ */
+type TIndexKey = {
+  readonly value: fieldvalue;
+  readonly number: number;
+  readonly id: entryid;
+}
+
+/**
+ * Lookup table for the CRC32C (Castagnoli) checksum, built on first use
+ */
+let crc32c_table: Uint32Array | null = null;
+
+/**
+ * Compute the CRC32C checksum of a string's UTF-8 bytes, the same checksum the TableFunctions tools compute
+ * @param data The string to checksum
+ * @returns The checksum as 8 lowercase hex digits
+ */
+function crc32c(data: string): string {
+  if (!crc32c_table) {
+    crc32c_table = new Uint32Array(256);
+    for (let i = 0; i < 256; i++) {
+      let value = i;
+      for (let bit = 0; bit < 8; bit++) value = (value >>> 1) ^ (0x82F63B78 & -(value & 1));
+      crc32c_table[i] = value >>> 0;
+    }
   }
 
+  let crc = 0xFFFFFFFF;
+  for (const byte of Buffer.from(data, 'utf8')) crc = crc32c_table[(crc ^ byte) & 0xFF] ^ (crc >>> 8);
+  return ((crc ^ 0xFFFFFFFF) >>> 0).toString(16).padStart(8, '0');
+}
+
+/**
+ * Appends every change made through the Table write methods to the change log file, in the order the changes are made.
+ * Other processes follow the log with a ChangeFeed instead of rescanning tables
+ * @note A database has a single writer: only one process at a time may connect to it without read_only.
+ * The writer keeps the sequence number of the last change and the next id of every table in memory, so a second writer would reuse them.
+ * Any number of other processes can connect with read_only, and see the writer's changes through this log
+ * @note The log is never truncated, as the positions its followers have read up to are not known to the writer.
+ * The README describes how to truncate it by hand while the database is not in use
+ */
+class ChangeLog {
   /**
-   * Change the parse function used to parse table entries
-   * @param parseFunction The function to use for parsing table entries, as all fields are by default unparsed strings and might need to be converted to numbers, booleans, dates, a class instance, etc.
-   * @note This will only affect the table object, not the table in the Database's memory. To update the table in the Database's memory, use the Database.set_parse_function() method
+   * The path to the change log file
    */
-  public set_parse_function(parseFunction: TParseEntryFieldsFunction): void {
-    this.parseFunction = parseFunction;
-  }
+  private static file: string = "./database/changes.log";
 
   /**
-   * Get the filepath of the entry with the given id
-   * @param id The id of the entry to get the filepath of
-   * @returns The filepath of the entry with the given id
+   * The open change log file, or null if the database is not connected
    */
-  public entry_path(id: entryid): string {
-    return this.folder + id;
-  }
+  private static fd: number | null = null;
 
   /**
-   * Get the next available id
-   * @returns The next available id
+   * The sequence number of the last change in the log
    */
-  private get_next_id(): entryid {
-    const ids = fs.readdirSync(this.folder);
-    if (!ids.length) return 1;
-    return Math.max(...ids) + 1;
-  }
+  private static last_seq: number = 0;
 
   /**
-   * Get all existing entry ids
-   * @returns Every existing entryid
+   * Open the change log for appending, creating it if it does not exist
+   * @param database_folder The path to the database root folder
    */
-  private get_all_ids(): Array<entryid> {
-    return fs.readdirSync(this.folder).map((id: string) => parseInt(id));
+  public static open(database_folder: string): void {
+    this.file = database_folder + "changes.log";
+    this.last_seq = this.read_last_seq();
+    this.fd = fs.openSync(this.file, 'a');
   }
 
   /**
-   * Write entry data to file
-   * @param id The id of the entry to write to file
-   * @param data The data to write to file
-   * @throws Error if a field is missing in data or if there are too many fields in data
+   * Close the change log
    */
-  private write_to_file(id: entryid, data: TEntry): void {
-    data['id'] = id.toString();
-    
-    let stringified_data = "";
-    for (const fieldname of this.fieldnames) {
-      const value = data[fieldname];
-      if (!value) throw new Error(`Field '${fieldname}' is missing in data`);
-      stringified_data += `${value}\n`;
-    }
+  public static close(): void {
+    if (this.fd !== null) fs.closeSync(this.fd);
+    this.fd = null;
+  }
 
-    if (Object.keys(data).length - 1 > this.fieldnames.length) throw new Error(`Too many fields in data`);
-    fs.writeFileSync(this.entry_path(id), stringified_data.substring(0, stringified_data.length - 1), { encoding: 'utf8', flag: 'w' });
+  /**
+   * Get the sequence number of the last change in the log
+   */
+  public static get_last_seq(): number {
+    return this.last_seq;
   }
 
   /**
-   * Get an entry
-   * @param id The id of the entry to get
-   * @returns The entry with the given id if it exists, otherwise null
+   * Append a change to the log
+   * @param table The name of the changed table
+   * @param id The id of the changed entry
+   * @param op The kind of change
+   * @param fields The fields of the change, see TChange.fields
    */
-  public get<T = TEntry>(id: entryid): T | null {
-    const record = this.get_unparsed(id);
-    return record ? this.parseFunction(record) : null;
+  public static append(table: string, id: entryid, op: TChange["op"], fields: TEntry): void {
+    this.append_all(table, op, [[id, fields]]);
   }
 
   /**
-   * Get an entry without parsing it using the table's parseFunction
-   * @param id The id of the entry to get
-   * @returns The entry with the given id if it exists, otherwise null
+   * Append changes of the same kind to the same table to the log with a single write
+   * @param table The name of the changed table
+   * @param op The kind of changes
+   * @param changes The id of each changed entry and the fields of its change, see TChange.fields
    */
-  public get_unparsed(id: entryid): TEntry | null {
-    if (!fs.existsSync(this.entry_path(id))) return null;
+  public static append_all(table: string, op: TChange["op"], changes: Array<[entryid, TEntry]>): void {
+    if (this.fd === null || !changes.length) return;
+    const ts = Date.now();
+    const lines = changes.map(([id, fields]: [entryid, TEntry], i: number) => {
+      const change: TChange = { seq: this.last_seq + i + 1, ts, table, id, op, fields };
+      return JSON.stringify(change) + "\n";
+    });
+    fs.writeSync(this.fd, lines.join(""));
+    this.last_seq += changes.length;
+  }
 
-    const raw_entry = fs.readFileSync(this.entry_path(id), { encoding: 'utf8', flag: 'r' });
-    const entries = raw_entry.split('\n');
-    
-    let record: TEntry = {};
-    for (let i = 0; i < this.fieldnames.length; i++) {
-      record[this.fieldnames[i]] = entries[i];
+  /**
+   * Read the sequence number of the last change in the log file by reading the end of the file.
+   * A partly written last line, left by a process that stopped while appending to the log, is removed
+   * @returns The sequence number of the last change, or 0 if the log is empty or does not exist
+   */
+  private static read_last_seq(): number {
+    if (!fs.existsSync(this.file)) return 0;
+
+    const fd = fs.openSync(this.file, 'r+');
+    try {
+      const size = fs.fstatSync(fd).size;
+      // read a larger part of the end of the file until it contains the whole last line
+      for (let length = 4096; ; length *= 2) {
+        const start = Math.max(0, size - length);
+        const buffer = Buffer.alloc(size - start);
+        fs.readSync(fd, buffer, 0, buffer.length, start);
+
+        const end_of_last_line = buffer.lastIndexOf(0x0A) + 1;
+        const start_of_last_line = end_of_last_line >= 2 ? buffer.lastIndexOf(0x0A, end_of_last_line - 2) + 1 : 0;
+        if (start > 0 && start_of_last_line === 0) continue;
+
+        if (start + end_of_last_line < size) fs.ftruncateSync(fd, start + end_of_last_line);
+        if (end_of_last_line === 0) return 0;
+        return JSON.parse(buffer.subarray(start_of_last_line, end_of_last_line - 1).toString('utf8')).seq;
+      }
+    } finally {
+      fs.closeSync(fd);
     }
-
-    return record;
   }
+}
 
+/**
+ * Coordinates the Table write methods with the tools that freeze writes while they copy the database, such as snapshot_db and incremental_backup.
+ * Every thread that writes has a marker file in the database's writes folder, whose first byte is 1 while one of its writes is in progress.
+ * A write sets its marker before it checks for the freeze file, and a tool creates the freeze file before it waits for every marker to be cleared,
+ * so either the write sees the freeze, or the tool waits for the write to finish.
+ * The scope of a write is a whole public write method, so a snapshot never holds part of a post_many, patch_where or delete_where
+ */
+class WriteFreeze {
   /**
-   * Create a new entry
-   * @param data The entry's data
-   * @returns The created entry
+   * The file that exists while a tool has frozen writes to the database
    */
-  public post(data: TEntry): TEntry {
-    const id = this.get_next_id();
-    this.write_to_file(id, data);
-    return this.parseFunction(data);
-  }
-  
+  private static freeze_file: string = "./database/snapshot.lock";
+
   /**
-   * Update an entry
-   * @param id The id of the entry to update
-   * @param updated_fields Record containing the fields to update
-   * @returns The updated entry
-   * @throws Error if the entry does not exist
+   * The marker file of this thread, named after the process id and the thread id
    */
-  public patch(id: entryid, updated_fields: TEntry): TEntry {
-    const current_data = this.get_unparsed(id);
-    const updated_data = { ...current_data, ...updated_fields };
-    if (!fs.existsSync(this.entry_path(id))) throw new Error(`Entry with id '${id}' does not exist`);
-    this.write_to_file(id, updated_data);
-    return this.parseFunction(updated_data);
-  }
+  private static marker_file: string = "";
 
   /**
-   * Delete an entry
-   * @param id The id of the entry to delete
-   * @throws Error if the entry does not exist
+   * The open marker file, or null if the database is not connected for writing
    */
-  public delete(id: entryid): TEntry {
-    const entry: TEntry = this.get(id)!;
-    if (!entry) throw new Error(`Entry with id '${id}' does not exist`);
-    fs.unlinkSync(this.entry_path(id));
-    return this.parseFunction(entry);
-  }
+  private static fd: number | null = null;
 
-  // *** FILTER-QUERY GET METHODS *** ///
+  /**
+   * The number of nested write scopes in progress, as the public write methods call each other
+   */
+  private static depth: number = 0;
 
   /**
-   * Get all entries in the table
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns Every entry in the table
-   * @throws Error if the database is not connected
+   * How long a write waits for a freeze to be lifted before it fails
    */
-  public get_all<T = TEntry>(): Array<T> {
-    return fs.readdirSync(this.folder).map((id: string) => this.parseFunction(this.get(parseInt(id))!));
-  }
-  
+  private static readonly timeout_ms: number = 10_000;
+
   /**
-   * Get all entries in the table in the form of TEntry records.
-   * Used internally to allow filter-queries to be applied to the table entries before parsing them
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns Every entry in the table without parsing the entry
-   * @throws Error if the database is not connected
+   * The cell a worker thread waits on with Atomics.wait() while writes are frozen, which nothing ever notifies
+   */
+  private static readonly wait_cell: Int32Array = new Int32Array(new SharedArrayBuffer(4));
+
+  /**
+   * Create the marker file of this thread
+   * @param database_folder The path to the database root folder
    */
-  private get_all_unparsed(): Array<TEntry> {
-    return fs.readdirSync(this.folder).map((id: string) => this.get_unparsed(parseInt(id))!);
+  public static open(database_folder: string): void {
+    this.freeze_file = database_folder + "snapshot.lock";
+    if (!fs.existsSync(database_folder + "writes/")) fs.mkdirSync(database_folder + "writes/");
+    // the process id lets the tools skip the marker of a process that stopped in the middle of a write
+    this.marker_file = `${database_folder}writes/${process.pid}.${worker_threads.threadId}`;
+    this.fd = fs.openSync(this.marker_file, 'w');
+    fs.writeSync(this.fd, `0 ${process.pid}\n`);
+    this.depth = 0;
   }
 
   /**
-   * Get all entries that pass the given filter
-   * @param filter The filter to apply to each of the entries
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries that pass the given filter
-   * @throws Error if the database is not connected
+   * Close and remove the marker file of this thread
    */
-  public get_with_filter<T = TEntry>(filter: TEntriesFilter): Array<T> {
-    return this.get_all_unparsed().filter(filter).map((entry: TEntry) => this.parseFunction(entry));
+  public static close(): void {
+    if (this.fd === null) return;
+    fs.closeSync(this.fd);
+    fs.unlinkSync(this.marker_file);
+    this.fd = null;
   }
 
   /**
-   * Assuming there is only one entry could/does th matches the search, get the entry that passes the given filter
-   * @param filter The filter to apply to each of the entries
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries that pass the given filter
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Check whether a tool has frozen writes to the database
    */
-  public get_unique_with_filter<T = TEntry>(filter: TEntriesFilter): T | null {
-    const result = this.get_all_unparsed().filter(filter);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  public static is_frozen(): boolean {
+    return this.fd !== null && fs.existsSync(this.freeze_file);
   }
 
   /**
-   * Get all entries where the given field is equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is equal to the given value
-   * @throws Error if the database is not connected
+   * Run a write method as one write, which a freeze either waits for or comes before.
+   * The main thread never blocks on a freeze, its writes fail instead; a worker thread waits for the freeze to be lifted
+   * @param write The write to run
+   * @returns What the write returns
+   * @throws Error if writes are frozen, on a worker thread only once they have been frozen for 10 seconds
    */
-  public get_where<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname] === value).map((entry: TEntry) => this.parseFunction(entry));
+  public static run<T>(write: () => T): T {
+    this.begin(worker_threads.isMainThread ? 0 : this.timeout_ms);
+    try {
+      return write();
+    } finally {
+      this.end();
+    }
   }
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is equal to the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Begin a write, waiting for a freeze to be lifted without blocking the event loop
+   * @throws Error if writes are still frozen after 10 seconds
    */
-  public get_unique_where<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname] === value);
-    if (result.length === 0) return null;
-    if (result.length > 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  public static async begin_async(): Promise<void> {
+    const deadline = Date.now() + this.timeout_ms;
+    while (!this.try_begin()) {
+      if (Date.now() > deadline) throw this.frozen_error();
+      await new Promise((resolve) => setTimeout(resolve, 5));
+    }
   }
 
   /**
-   * Get all entries where the given field is not equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is not equal to the given value
-   * @throws Error if the database is not connected
+   * End a write begun with run() or begin_async(), clearing the marker once the outermost write ends
    */
-  public get_where_not<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname] !== value).map((entry: TEntry) => this.parseFunction(entry));
+  public static end(): void {
+    if (--this.depth > 0 || this.fd === null) return;
+    fs.writeSync(this.fd, "0", 0);
   }
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is not equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is not equal to the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Begin a write, blocking the thread while writes are frozen
+   * @param timeout_ms How long to wait for a freeze to be lifted, 0 to fail at once
+   * @throws Error if writes are still frozen after the timeout
    */
-  public get_unique_where_not<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname] !== value);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  private static begin(timeout_ms: number): void {
+    const deadline = Date.now() + timeout_ms;
+    while (!this.try_begin()) {
+      if (Date.now() >= deadline) throw this.frozen_error();
+      Atomics.wait(this.wait_cell, 0, 0, 5);
+    }
   }
 
   /**
-   * Get all entries where the given field is greater than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is greater than the given value
-   * @throws Error if the database is not connected
+   * Set the marker and check for the freeze file, clearing the marker again if writes are frozen
+   * @returns Whether the write has begun
    */
-  public get_where_gt<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) > value).map((entry: TEntry) => this.parseFunction(entry));
+  private static try_begin(): boolean {
+    if (this.depth++ > 0 || this.fd === null) return true;
+    fs.writeSync(this.fd, "1", 0);
+    if (!fs.existsSync(this.freeze_file)) return true;
+    this.end();
+    return false;
   }
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is greater than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is greater than the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The error of a write that was not made because writes are frozen
    */
-  public get_unique_where_gt<T = TEntry>(fieldname: fieldname, value: number): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) > value);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  private static frozen_error(): Error {
+    return new Error(`Writes are frozen by '${this.freeze_file}' while a snapshot or backup is taken - delete it if no tool is running`);
   }
+}
 
+/**
+ * Follows the change log of the database, returning each change once and in order.
+ * Used by other processes or services to react to changes without rescanning tables
+ *
+ * @example
+ * const feed = new ChangeFeed(last_handled_seq);
+ * feed.watch((changes: Array<TChange>) => changes.forEach(invalidate_cache));
+ */
+export class ChangeFeed {
   /**
-   * Get all entries where the given field is less than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is less than the given value
-   * @throws Error if the database is not connected
+   * The path to the change log file
    */
-  public get_where_lt<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) < value).map((entry: TEntry) => this.parseFunction(entry));
-  }
+  private readonly file: string;
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is less than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is less than the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The sequence number of the last change returned
    */
-  public get_unique_where_lt<T = TEntry>(fieldname: fieldname, value: number): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) < value);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
-  }
+  private last_seq: number;
 
   /**
-   * Get all entries where the given field is greater than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is greater than or equal to the given value
-   * @throws Error if the database is not connected
+   * The position in the change log file up to which changes have been read
    */
-  public get_where_gte<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) >= value).map((entry: TEntry) => this.parseFunction(entry));
-  }
+  private offset: number = 0;
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is greater than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is greater than or equal to the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The end of the change log that has been read but does not yet form a whole line
    */
-  public get_unique_where_gte<T = TEntry>(fieldname: fieldname, value: number): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) >= value);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
-  }
+  private partial_line: Buffer = Buffer.alloc(0);
 
   /**
-   * Get all entries where the given field is less than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is less than or equal to the given value
-   * @throws Error if the database is not connected
+   * The watcher notifying the feed of appends to the change log, if the feed is watching
    */
-  public get_where_lte<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) <= value).map((entry: TEntry) => this.parseFunction(entry));
-  }
+  private watcher: any = null;
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field is less than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field is less than or equal to the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Create a feed of the changes made after the given change
+   * @param after_seq The sequence number of the last change already handled, 0 to get every change in the log
+   * @param file The path to the change log file, defaults to the change log of the database in the working directory
+   * @param offset A position in the change log file before the first change to return, to skip reading the changes before it
    */
-  public get_unique_where_lte<T = TEntry>(fieldname: fieldname, value: number): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => parseFloat(entry[fieldname]) <= value);
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  constructor(after_seq: number = 0, file: string = "./database/changes.log", offset: number = 0) {
+    this.last_seq = after_seq;
+    this.file = file;
+    this.offset = offset;
   }
 
   /**
-   * Get all entries where the given field contains the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field contains the given value
-   * @throws Error if the database is not connected
+   * Get the changes appended to the change log since the last call
+   * @returns The new changes, in the order they were made
    */
-  public get_where_contains<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].includes(value)).map((entry: TEntry) => this.parseFunction(entry));
+  public poll(): Array<TChange> {
+    if (!fs.existsSync(this.file)) return [];
+
+    const size = fs.statSync(this.file).size;
+    if (size < this.offset) {
+      // the change log was replaced, so it is read again from the start and changes are skipped by sequence number
+      this.offset = 0;
+      this.partial_line = Buffer.alloc(0);
+    }
+    if (size === this.offset) return [];
+
+    const buffer = Buffer.alloc(size - this.offset);
+    const fd = fs.openSync(this.file, 'r');
+    fs.readSync(fd, buffer, 0, buffer.length, this.offset);
+    fs.closeSync(fd);
+    this.offset = size;
+
+    const data = Buffer.concat([this.partial_line, buffer]);
+    const end_of_last_line = data.lastIndexOf(0x0A) + 1;
+    this.partial_line = data.subarray(end_of_last_line);
+
+    const changes: Array<TChange> = data.subarray(0, end_of_last_line).toString('utf8').split("\n")
+      .filter((line: string) => line.length != 0)
+      .map((line: string) => JSON.parse(line))
+      .filter((change: TChange) => change.seq > this.last_seq);
+
+    if (changes.length) this.last_seq = changes[changes.length - 1].seq;
+    return changes;
   }
-  
+
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field contains the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field contains the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Call the callback with the new changes every time changes are appended to the change log,
+   * starting with the changes already in the log
+   * @param callback The function to call with the new changes, in the order they were made
+   * @throws Error if the change log does not exist or the feed is already watching
    */
-  public get_unique_where_contains<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].includes(value));
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  public watch(callback: (changes: Array<TChange>) => void): void {
+    if (this.watcher) throw new Error("Change feed is already watching");
+    this.watcher = fs.watch(this.file, () => {
+      const changes = this.poll();
+      if (changes.length) callback(changes);
+    });
+
+    const changes = this.poll();
+    if (changes.length) callback(changes);
   }
 
   /**
-   * Get all entries where the given field does not contain the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field does not contain the given value
-   * @throws Error if the database is not connected
+   * Get the position of the feed in the change log, to create a feed that continues from it in another process
+   * @returns The sequence number of the last change returned, and the position in the change log file after it
    */
-  public get_where_not_contains<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => !entry[fieldname].includes(value)).map((entry: TEntry) => this.parseFunction(entry));
+  public get_position(): { seq: number, offset: number } {
+    return { seq: this.last_seq, offset: this.offset - this.partial_line.length };
   }
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field does not contain the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field does not contain the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Stop watching the change log
    */
-  public get_unique_where_not_contains<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => !entry[fieldname].includes(value));
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
+  public close(): void {
+    if (this.watcher) this.watcher.close();
+    this.watcher = null;
   }
+}
 
+/**
+ * A sorted index of the values of a table's field, built by the build_index tool and loaded on first use.
+ * The index file holds the keys as of a change in the change log, and every later change is applied to the index
+ * before each lookup, so the index includes the writes of the database's writer even when it runs in another process (see ChangeLog)
+ */
+class SecondaryIndex {
   /**
-   * Get all entries where the given field starts with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field starts with the given value
-   * @throws Error if the database is not connected
+   * The path to the index file
    */
-  public get_where_starts_with<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].startsWith(value)).map((entry: TEntry) => this.parseFunction(entry));
-  }
+  private readonly file: string;
 
   /**
-   * Assuming there is only one entry that could/does match the search, get the entry where the given field starts with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field starts with the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The name of the indexed table
    */
-  public get_unique_where_starts_with<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].startsWith(value));
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
-  }
+  private readonly table: string;
 
   /**
-   * Get all entries where the given field ends with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field ends with the given value
-   * @throws Error if the database is not connected
+   * The name of the indexed field
    */
-  public get_where_ends_with<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
-    return this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].endsWith(value)).map((entry: TEntry) => this.parseFunction(entry));
-  }
+  private readonly fieldname: fieldname;
 
   /**
-   * Assumes there is only one entry that could/does match the search, get the entry where the given field ends with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries where the given field ends with the given value
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The path to the change log of the database
    */
-  public get_unique_where_ends_with<T = TEntry>(fieldname: fieldname, value: string): T | null {
-    const result = this.get_all_unparsed().filter((entry: TEntry) => entry[fieldname].endsWith(value));
-    if (result.length === 0) return null;
-    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
-    return this.parseFunction(result[0]);
-  }
+  private readonly change_log: string;
 
-  // *** FILTER-QUERY PATCH METHODS *** ///
+  /**
+   * The keys, sorted by value: numbers first in numeric order, then other values in string order, then by id
+   */
+  private keys: Array<TIndexKey> = [];
 
   /**
-   * Update all entries in the table with the values in updated_fields
-   * @param updated_fields The fields to update
-   * @warning be careful using this method
+   * The indexed value of every entry, to find the key of an entry when it changes
    */
-  public patch_all(updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => this.patch(id, updated_fields));
-  }
+  private values: Map<entryid, fieldvalue> = new Map();
 
   /**
-   * Update all entries that pass the given filter
-   * @param filter The filter to apply to each of the entries
+   * The feed of the changes made after the index was loaded, null until the index is loaded
    */
-  public patch_with_filter(filter: TEntriesFilter, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (filter(this.get_unparsed(id)!)) this.patch(id, updated_fields);
-    });
-  }
+  private feed: ChangeFeed | null = null;
 
   /**
-   * Update all entries in the table with the values in updated_fields where the given field is equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * The largest batch of changes applied by splicing each changed key into the keys, each splice moves the keys after it
    */
-  public patch_where(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] === value) this.patch(id, updated_fields);
-    });
-  }
+  private static readonly splice_limit: number = 16;
 
   /**
-   * Get all entries where the given field is not equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * @param file The path to the index file
+   * @param table The name of the indexed table
+   * @param fieldname The name of the indexed field
+   * @param change_log The path to the change log of the database
    */
-  public patch_where_not(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] !== value) this.patch(id, updated_fields);
-    });
+  constructor(file: string, table: string, fieldname: fieldname, change_log: string) {
+    this.file = file;
+    this.table = table;
+    this.fieldname = fieldname;
+    this.change_log = change_log;
   }
 
   /**
-   * Get all entries where the given field is greater than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Order two keys of the index
+   * @returns A negative number if a comes first, a positive number if b comes first, 0 if they are the same key
    */
-  public patch_where_gt(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] > value) this.patch(id, updated_fields);
-    });
+  private static compare(a: TIndexKey, b: TIndexKey): number {
+    const a_numeric = !isNaN(a.number), b_numeric = !isNaN(b.number);
+    if (a_numeric !== b_numeric) return a_numeric ? -1 : 1;
+    if (a_numeric && a.number !== b.number) return a.number < b.number ? -1 : 1;
+    if (a.value !== b.value) return a.value < b.value ? -1 : 1;
+    return a.id - b.id;
   }
 
   /**
-   * Get all entries where the given field is less than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Find the position of the first key for which a condition is false, the condition must be true for every key before it
    */
-  public patch_where_lt(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] < value) this.patch(id, updated_fields);
-    });
+  private partition_point(condition: (key: TIndexKey) => boolean): number {
+    let low = 0, high = this.keys.length;
+    while (low < high) {
+      const middle = (low + high) >>> 1;
+      if (condition(this.keys[middle])) low = middle + 1;
+      else high = middle;
+    }
+    return low;
   }
 
   /**
-   * Get all entries where the given field is greater than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Load the index file and apply the changes made since it was written
+   * @returns false if the index file does not exist
    */
-  public patch_where_gte(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] >= value) this.patch(id, updated_fields);
-    });
+  private load(): boolean {
+    if (!fs.existsSync(this.file)) return false;
+    const start = Tracer.begin();
+    const lines = fs.readFileSync(this.file, { encoding: 'utf8', flag: 'r' }).split("\n");
+    // the first line holds the last change included in the index and the position after it in the change log
+    const [, seq, offset] = lines[0].split(" ");
+
+    this.keys = [];
+    for (let i = 1; i < lines.length; i++) {
+      const separator = lines[i].indexOf(" ");
+      if (separator === -1) continue;
+      const value = lines[i].substring(separator + 1);
+      this.keys.push({ value, number: parseFloat(value), id: parseInt(lines[i].substring(0, separator)) });
+    }
+
+    // the build_index tool orders strings by their UTF-8 bytes, which differs from JavaScript's order for a few characters
+    if (this.keys.some((key: TIndexKey, i: number) => i > 0 && SecondaryIndex.compare(this.keys[i - 1], key) > 0)) this.keys.sort(SecondaryIndex.compare);
+    this.values = new Map(this.keys.map((key: TIndexKey) => [key.id, key.value]));
+    this.feed = new ChangeFeed(parseInt(seq), this.change_log, parseInt(offset));
+    Tracer.end("index load", "index", start, { table: this.table, field: this.fieldname, keys: this.keys.length });
+    return true;
   }
 
   /**
-   * Get all entries where the given field is less than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Apply the changes made to the indexed table since the last lookup.
+   * A few changes are spliced into the keys one by one, a larger batch is merged into them at once like the build_index tool does
    */
-  public patch_where_lte(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] <= value) this.patch(id, updated_fields);
-    });
+  private catch_up(): void {
+    // the latest value of every changed entry, null if it was deleted
+    const changes: Map<entryid, fieldvalue | null> = new Map();
+    for (const change of this.feed!.poll()) {
+      if (change.table !== this.table) continue;
+      if (change.op === "delete") changes.set(change.id, null);
+      else if (this.fieldname in change.fields) changes.set(change.id, change.fields[this.fieldname]);
+    }
+
+    if (changes.size <= SecondaryIndex.splice_limit) {
+      for (const [id, value] of changes) {
+        if (value === null) this.remove(id);
+        else this.set(id, value);
+      }
+      return;
+    }
+
+    const kept = this.keys.filter((key: TIndexKey) => !changes.has(key.id));
+    const added: Array<TIndexKey> = [];
+    for (const [id, value] of changes) {
+      if (value === null) {
+        this.values.delete(id);
+      } else {
+        added.push({ value, number: parseFloat(value), id });
+        this.values.set(id, value);
+      }
+    }
+    added.sort(SecondaryIndex.compare);
+
+    this.keys = new Array(kept.length + added.length);
+    for (let i = 0, j = 0, k = 0; k < this.keys.length; k++) {
+      this.keys[k] = j >= added.length || (i < kept.length && SecondaryIndex.compare(kept[i], added[j]) < 0) ? kept[i++] : added[j++];
+    }
   }
 
   /**
-   * Get all entries where the given field contains the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Set the indexed value of an entry
    */
-  public patch_where_contains(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].includes(value)) this.patch(id, updated_fields);
-    }); 
+  private set(id: entryid, value: fieldvalue): void {
+    this.remove(id);
+    const key: TIndexKey = { value, number: parseFloat(value), id };
+    this.keys.splice(this.partition_point((other: TIndexKey) => SecondaryIndex.compare(other, key) < 0), 0, key);
+    this.values.set(id, value);
   }
 
   /**
-   * Get all entries where the given field does not contain the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Remove the key of an entry from the index
    */
-  public patch_where_not_contains(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (!this.get_unparsed(id)![fieldname].includes(value)) this.patch(id, updated_fields);
-    });
+  private remove(id: entryid): void {
+    const value = this.values.get(id);
+    if (value === undefined) return;
+    const key: TIndexKey = { value, number: parseFloat(value), id };
+    this.keys.splice(this.partition_point((other: TIndexKey) => SecondaryIndex.compare(other, key) < 0), 1);
+    this.values.delete(id);
   }
 
   /**
-   * Get all entries where the given field starts with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Check that the index can answer lookups, loading the index file if it is not loaded yet. Once loaded, lookups never return null
+   * @returns false if the index file does not exist
    */
-  public patch_where_starts_with(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].startsWith(value)) this.patch(id, updated_fields);
-    });
+  public is_available(): boolean {
+    return this.feed !== null || this.load();
   }
 
   /**
-   * Get all entries where the given field ends with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
+   * Get the number of entries in the index, which is every entry of the table
+   * @returns The number of entries, or null if the index file does not exist
    */
-  public patch_where_ends_with(fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].endsWith(value)) this.patch(id, updated_fields);
-    });
+  public size(): number | null {
+    if (!this.feed && !this.load()) return null;
+    this.catch_up();
+    return this.values.size;
   }
 
-  // *** FILTER-QUERY DELETE METHODS *** ///
-
   /**
-   * Delete all entries
-   * @warning be careful using this method
+   * Get the ids of the entries whose indexed field matches a comparison
+   * @param comparison The comparison of the field with the value
+   * @param value The value to compare the field with
+   * @returns The ids of the matching entries in index order, or null if the index file does not exist
    */
-  public delete_all(): void {
-    this.get_all_ids().forEach((id: entryid) => this.delete(id));
+  public lookup(comparison: TComparison, value: fieldvalue | number): Array<entryid> | null {
+    if (!this.feed && !this.load()) return null;
+    this.catch_up();
+
+    const number = typeof value === "number" ? value : parseFloat(value);
+    const is_number = (key: TIndexKey): boolean => !isNaN(key.number);
+    let first: number, last: number;
+    if (comparison === "==") {
+      const key: TIndexKey = { value: value.toString(), number, id: -Infinity };
+      first = this.partition_point((other: TIndexKey) => SecondaryIndex.compare(other, key) < 0);
+      last = this.partition_point((other: TIndexKey) => SecondaryIndex.compare(other, key) < 0 || other.value === key.value);
+    } else if (isNaN(number)) {
+      return [];
+    } else if (comparison === ">" || comparison === ">=") {
+      first = this.partition_point((key: TIndexKey) => is_number(key) && (comparison === ">" ? key.number <= number : key.number < number));
+      last = this.partition_point(is_number);
+    } else {
+      first = 0;
+      last = this.partition_point((key: TIndexKey) => is_number(key) && (comparison === "<" ? key.number < number : key.number <= number));
+    }
+
+    return this.keys.slice(first, last).map((key: TIndexKey) => key.id);
   }
+}
 
+/**
+ * An in-memory full-text index of a table's field, ranking entries for word queries with BM25.
+ * Built from a scan of the table on the first search of the field, then kept up to date from the change log before each search
+ */
+class FullTextIndex {
   /**
-   * Delete all entries that pass the given filter
-   * @param filter The filter to apply to each of the entries
+   * The name of the indexed table
    */
-  public delete_with_filter(filter: TEntriesFilter): void {
-    const entries_with_ids: Array<TEntry> = this.get_all_unparsed().map((entry: TEntry, index: number) => {
-      entry['id'] = index.toString();
-      return entry;
-    });
-    entries_with_ids.filter(filter).map((entry: TEntry) => this.delete(parseInt(entry.id)));
-  }
+  private readonly table: string;
 
   /**
-   * Delete all entries where the given field is equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * The name of the indexed field
    */
-  public delete_where(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] === value) this.delete(id);
-    }); 
-  }
+  private readonly fieldname: fieldname;
 
   /**
-   * Delete all entries where the given field is not equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * The feed of the changes made since the table was scanned
    */
-  public delete_where_not(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] !== value) this.delete(id);
-    });
+  private readonly feed: ChangeFeed;
+
+  /**
+   * The postings of every term: the ids of the entries containing the term, and how many times it occurs in each
+   */
+  private readonly postings: Map<string, Map<entryid, number>> = new Map();
+
+  /**
+   * The distinct terms and the number of terms of every indexed entry
+   */
+  private readonly documents: Map<entryid, { readonly terms: Array<string>, readonly length: number }> = new Map();
+
+  /**
+   * The sum of the number of terms of every indexed entry
+   */
+  private total_length: number = 0;
+
+  /**
+   * BM25 parameters: how quickly repeated terms stop adding to the score, and how much long fields are penalized
+   */
+  private static readonly k1: number = 1.2;
+  private static readonly b: number = 0.75;
+
+  /**
+   * @param table The name of the indexed table
+   * @param fieldname The name of the indexed field
+   * @param entries The id and field value of every entry of the table
+   * @param feed The feed of the changes made since the entries were read
+   */
+  constructor(table: string, fieldname: fieldname, entries: Array<[entryid, fieldvalue]>, feed: ChangeFeed) {
+    this.table = table;
+    this.fieldname = fieldname;
+    this.feed = feed;
+    for (const [id, text] of entries) this.add(id, text);
   }
 
   /**
-   * Delete all entries where the given field is greater than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Split a text into lowercase terms, with accents removed so "Café" matches "cafe"
+   * @param text The text to split
+   * @returns The terms of the text, in order
    */
-  public delete_where_gt(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] > value) this.delete(id);
-    });
+  public static tokenize(text: string): Array<string> {
+    return text.normalize('NFKD').replace(/[\u0300-\u036f]/g, '').toLowerCase().split(/[^\p{L}\p{N}]+/u).filter((term: string) => term.length != 0);
   }
 
   /**
-   * Delete all entries where the given field is less than the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Index the field value of an entry, replacing its previous value
    */
-  public delete_where_lt(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] < value) this.delete(id);
-    });
+  private add(id: entryid, text: fieldvalue): void {
+    this.remove(id);
+    const terms = FullTextIndex.tokenize(text);
+    const frequencies: Map<string, number> = new Map();
+    for (const term of terms) frequencies.set(term, (frequencies.get(term) ?? 0) + 1);
+
+    for (const [term, frequency] of frequencies) {
+      if (!this.postings.has(term)) this.postings.set(term, new Map());
+      this.postings.get(term)!.set(id, frequency);
+    }
+    this.documents.set(id, { terms: [...frequencies.keys()], length: terms.length });
+    this.total_length += terms.length;
   }
 
   /**
-   * Delete all entries where the given field is greater than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Remove an entry from the index
    */
-  public delete_where_gte(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] >= value) this.delete(id);
-    });
+  private remove(id: entryid): void {
+    const document = this.documents.get(id);
+    if (!document) return;
+
+    for (const term of document.terms) {
+      const posting = this.postings.get(term)!;
+      posting.delete(id);
+      if (posting.size === 0) this.postings.delete(term);
+    }
+    this.documents.delete(id);
+    this.total_length -= document.length;
   }
 
   /**
-   * Delete all entries where the given field is less than or equal to the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Apply the changes made to the indexed table since the last search
    */
-  public delete_where_lte(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname] <= value) this.delete(id);
-    });
+  private catch_up(): void {
+    for (const change of this.feed.poll()) {
+      if (change.table !== this.table) continue;
+      if (change.op === "delete") this.remove(change.id);
+      else if (this.fieldname in change.fields) this.add(change.id, change.fields[this.fieldname]);
+    }
   }
 
   /**
-   * Delete all entries where the given field contains the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Rank the entries containing any of the terms of a query, keeping only the best k in a min-heap instead of sorting every match
+   * @param query The words to search for
+   * @param k The number of best matches to return
+   * @returns The ids of the k best matching entries, with their BM25 scores, best match first
    */
-  public delete_where_contains(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].includes(value)) this.delete(id);
-    });
+  public search(query: string, k: number): Array<{ id: entryid, score: number }> {
+    this.catch_up();
+    const scores: Map<entryid, number> = new Map();
+    const average_length = this.total_length / Math.max(1, this.documents.size);
+
+    for (const term of new Set(FullTextIndex.tokenize(query))) {
+      const posting = this.postings.get(term);
+      if (!posting) continue;
+
+      // terms found in fewer entries weigh more
+      const idf = Math.log(1 + (this.documents.size - posting.size + 0.5) / (posting.size + 0.5));
+      for (const [id, frequency] of posting) {
+        const length_norm = 1 - FullTextIndex.b + FullTextIndex.b * this.documents.get(id)!.length / average_length;
+        const score = idf * frequency * (FullTextIndex.k1 + 1) / (frequency + FullTextIndex.k1 * length_norm);
+        scores.set(id, (scores.get(id) ?? 0) + score);
+      }
+    }
+
+    // the root of the heap is the worst of the best matches found so far
+    const heap: Array<{ id: entryid, score: number }> = [];
+    for (const [id, score] of scores) {
+      if (heap.length < k) {
+        heap.push({ id, score });
+        FullTextIndex.sift_up(heap, heap.length - 1);
+      } else if (k > 0 && FullTextIndex.is_worse(heap[0], { id, score })) {
+        heap[0] = { id, score };
+        FullTextIndex.sift_down(heap, 0);
+      }
+    }
+
+    return heap.sort((a, b) => b.score - a.score || a.id - b.id);
   }
 
   /**
-   * Delete all entries where the given field does not contain the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Check if a match ranks below another: a lower score, or the same score and a higher id
    */
-  public delete_where_not_contains(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (!this.get_unparsed(id)![fieldname].includes(value)) this.delete(id);
-    });
+  private static is_worse(a: { id: entryid, score: number }, b: { id: entryid, score: number }): boolean {
+    return a.score < b.score || (a.score === b.score && a.id > b.id);
   }
 
   /**
-   * Delete all entries where the given field starts with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Move a match added at the end of the heap up until its parent ranks below it
    */
-  public delete_where_starts_with(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].startsWith(value)) this.delete(id);
-    });
+  private static sift_up(heap: Array<{ id: entryid, score: number }>, i: number): void {
+    while (i > 0) {
+      const parent = (i - 1) >> 1;
+      if (!FullTextIndex.is_worse(heap[i], heap[parent])) break;
+      [heap[i], heap[parent]] = [heap[parent], heap[i]];
+      i = parent;
+    }
   }
 
   /**
-   * Delete all entries where the given field ends with the given value
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
+   * Move a match put at the root of the heap down until both of its children rank above it
    */
-  public delete_where_ends_with(fieldname: fieldname, value: string): void {
-    this.get_all_ids().forEach((id: entryid) => {
-      if (this.get_unparsed(id)![fieldname].endsWith(value)) this.delete(id);
-    });
+  private static sift_down(heap: Array<{ id: entryid, score: number }>, i: number): void {
+    while (true) {
+      let worst = i;
+      for (const child of [2 * i + 1, 2 * i + 2]) {
+        if (child < heap.length && FullTextIndex.is_worse(heap[child], heap[worst])) worst = child;
+      }
+      if (worst === i) break;
+      [heap[i], heap[worst]] = [heap[worst], heap[i]];
+      i = worst;
+    }
   }
 }
 
 /**
- * Static Database class for interacting with the MDBL database
+ * An in-memory hash index of a table's field, finding the entries with a given value without reading the index from disk.
+ * Built from a scan of the table by Table.create_hash_index(), then kept up to date from the change log before each lookup.
+ * The index is saved to an image file, so the next process loads it instead of scanning the table again
  */
-export default class Database {
+class HashIndex {
   /**
-   * The path to the database root folder
+   * The name of the indexed table
    */
-  private static readonly database_folder: string = "./database/";
-  
+  private readonly table: string;
+
   /**
-   * The path to the table.info file
+   * The name of the indexed field
    */
-  private static readonly tables_info_file: string = this.database_folder + "table.info";
-  
+  private readonly fieldname: fieldname;
+
   /**
-   * The tables in the database
+   * The feed of the changes made since the table was scanned
    */
-  private static tables: Array<Table> = [];
+  private readonly feed: ChangeFeed;
 
   /**
-   * Connected status
+   * The ids of the entries holding every value of the field
    */
-  private static connected: boolean = false;
+  private readonly ids: Map<fieldvalue, Set<entryid>> = new Map();
 
   /**
-   * @note This method is required before calling any other methods
-   * Connect to the database,
-   * create the neccessary files if they do not exist, 
-   * and create existing tables from the table information in the file
-   * @throws Error if the database is already connected
+   * The indexed value of every entry, to find the entry's previous value when it changes
    */
-  public static connect(): void {
-    if (this.connected) throw new Error("Database already connected");
-    
-    if (!fs.existsSync(this.database_folder)) {
-      fs.mkdir(this.database_folder, (err: any) => {
-        if (err) throw err;
-      });
-    }
-
-    if (fs.existsSync(this.tables_info_file)) {
-      this.tables = fs.readFileSync(this.tables_info_file, { encoding: 'utf8', flag: 'r' }).split("\r\n").filter((line: string) => line.length != 0).map((line: string) => new Table(JSON.parse(line)));
-    }
+  private readonly values: Map<entryid, fieldvalue> = new Map();
 
-    this.connected = true;
+  /**
+   * @param table The name of the indexed table
+   * @param fieldname The name of the indexed field
+   * @param entries The id and field value of every entry of the table
+   * @param feed The feed of the changes made since the entries were read
+   */
+  constructor(table: string, fieldname: fieldname, entries: Array<[entryid, fieldvalue]>, feed: ChangeFeed) {
+    this.table = table;
+    this.fieldname = fieldname;
+    this.feed = feed;
+    for (const [id, value] of entries) this.set(id, value);
   }
 
   /**
-   * Disconnect from the database
-   * @throws Error if the database was not previously connected
+   * Index the field value of an entry, replacing its previous value
    */
-  public static disconnect(): void {
-    if (!this.connected) throw new Error("Database not connected");
-    this.tables = [];
-    this.connected = false;
+  private set(id: entryid, value: fieldvalue): void {
+    this.remove(id);
+    if (!this.ids.has(value)) this.ids.set(value, new Set());
+    this.ids.get(value)!.add(id);
+    this.values.set(id, value);
   }
 
   /**
-   * Get an existing table from the database
-   * @param tablename The name of the table to get
-   * @returns The given table
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Remove an entry from the index
    */
-  public static get_table(tablename: string): Table {
-    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
-    const table = this.tables.find((table: Table) => table.name == tablename);
-    if (!table) throw new Error(`Table ${tablename} does not exist`);
-    return table;
+  private remove(id: entryid): void {
+    const value = this.values.get(id);
+    if (value === undefined) return;
+
+    const ids = this.ids.get(value)!;
+    ids.delete(id);
+    if (ids.size === 0) this.ids.delete(value);
+    this.values.delete(id);
   }
 
   /**
-   * Set the parse function for the given table
-   * @param tablename The name of the table to set the parse function for
-   * @param parseFunction The function to use to parse the entry fields
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Apply the changes made to the indexed table since the last lookup
    */
-  public static set_table_parse_function(tablename: string, parseFunction: TParseEntryFieldsFunction): void {
-    for (let i = 0; i < this.tables.length; i++) {
-      if (this.tables[i].name != tablename) continue;
-      return this.tables[i].set_parse_function(parseFunction);
+  private catch_up(): void {
+    for (const change of this.feed.poll()) {
+      if (change.table !== this.table) continue;
+      if (change.op === "delete") this.remove(change.id);
+      else if (this.fieldname in change.fields) this.set(change.id, change.fields[this.fieldname]);
     }
   }
 
   /**
-   * Get an entry with the given id from the given table
-   * @param tablename The name of the table to get the entry from
-   * @param id The id of the entry to get
-   * @returns The entry with the given id if it exists, otherwise null
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Get the number of entries in the index, which is every entry of the table
    */
-  public static get<T = TEntry>(tablename: string, id: entryid): T | null {
-    const table = this.get_table(tablename);
-    return table.get<T>(id);
+  public size(): number {
+    this.catch_up();
+    return this.values.size;
   }
 
   /**
-   * Create a new entry in the given table
-   * @param tablename The name of the table to create the entry in
-   * @param data The entry data
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Load an index from its image file, without scanning the table
+   * @param file The path to the image file
+   * @param table The name of the indexed table
+   * @param fieldname The name of the indexed field
+   * @param change_log The path to the change log of the database
+   * @returns The index, or null if there is no image or it is not from the current change log
    */
-  public static post(tablename: string, data: TEntry): void {
-    const table = this.get_table(tablename);
-    table.post(data);
+  public static load(file: string, table: string, fieldname: fieldname, change_log: string): HashIndex | null {
+    if (!fs.existsSync(file)) return null;
+    const lines = fs.readFileSync(file, { encoding: 'utf8', flag: 'r' }).split('\n');
+    const [, seq, offset] = lines[0].split(' ').map((part: string) => parseInt(part));
+
+    // a change log shorter than the image's position was replaced, so changes may have been made that the image cannot catch up with
+    if (!fs.existsSync(change_log) || fs.statSync(change_log).size < offset) return null;
+
+    const entries: Array<[entryid, fieldvalue]> = [];
+    for (let i = 1; i < lines.length; i++) {
+      const separator = lines[i].indexOf(' ');
+      if (separator !== -1) entries.push([parseInt(lines[i].substring(0, separator)), lines[i].substring(separator + 1)]);
+    }
+    return new HashIndex(table, fieldname, entries, new ChangeFeed(seq, change_log, offset));
   }
 
   /**
-   * Update the entry with the given id in the given table
-   * @param tablename The name of the table to update the entry in
-   * @param id The id of the entry to update
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Save the index to its image file: the sequence number of the last change applied and the position after it in the change log,
+   * then the id and value of every entry one per line. The image is written to a temporary file which then replaces the image file
+   * @param file The path to the image file
    */
-  public static patch(tablename: string, id: entryid, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch(id, updated_fields);
+  public save(file: string): void {
+    this.catch_up();
+    const { seq, offset } = this.feed.get_position();
+    const lines = [`seq ${seq} ${offset}`];
+    for (const [id, value] of this.values) lines.push(`${id} ${value}`);
+    fs.writeFileSync(file + ".tmp", lines.join('\n'));
+    fs.renameSync(file + ".tmp", file);
   }
 
   /**
-   * Delete the entry with the given id from the given table
-   * @param tablename The name of the table to delete the entry from
-   * @param id The id of the entry to delete
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Find the entries whose field is equal to a value
+   * @param value The value to find
+   * @returns The ids of the entries holding the value, in ascending order
    */
-  public static delete(tablename: string, id: entryid): void {
-    const table = this.get_table(tablename);
-    table.delete(id);
+  public lookup(value: fieldvalue): Array<entryid> {
+    this.catch_up();
+    return [...this.ids.get(value) ?? []].sort((a: entryid, b: entryid) => a - b);
   }
 
-  /// *** FILTER-QUERY GET METHODS *** ///
-
   /**
-   * Get all entries from the given table
-   * @param tablename The name of the table to get the entry from
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Find the entries whose field value passes a test, e.g. the expiry times that have passed
+   * @param test The test of a value
+   * @returns The ids of the entries holding a passing value
    */
-  public static get_all<T = TEntry>(tablename: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_all<T>();
+  public filter(test: (value: fieldvalue) => boolean): Array<entryid> {
+    this.catch_up();
+    const ids: Array<entryid> = [];
+    for (const [value, value_ids] of this.ids) if (test(value)) ids.push(...value_ids);
+    return ids;
   }
+}
+
+/**
+ * A frame of the entry cache, holding one entry
+ */
+type TCacheFrame = {
+  key: string;
+  entry: TEntry;
+  bytes: number;
 
   /**
-   * Get all entries from the given table that pass the given filter
-   * @param tablename The name of the table to get the entry from 
-   * @param filter The filter to apply to the entries
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The entries that pass the given filter
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Set when the entry is read, cleared when the clock hand passes the frame; a frame is evicted when the hand passes it while cleared
    */
-  public static get_with_filter<T = TEntry>(tablename: string, filter: TEntriesFilter): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_with_filter<T>(filter);
-  }
+  referenced: boolean;
+}
 
+/**
+ * Keeps recently read entries in memory, within a fixed memory budget shared by every table of the database.
+ * When the budget is full, entries are evicted with the clock-sweep policy, which keeps entries that are read again.
+ * Entries read by scans go through a small ring instead, so a scan of a large table does not evict the entries read by lookups.
+ * Entries changed by the database's writer are dropped from the cache using the change log, also when it runs in another process (see ChangeLog)
+ */
+class EntryCache {
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field passes the filter
-   * @param tablename The name of the table to get the entry from 
-   * @param filter The filter to apply to the entries
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry that passes the given filter
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The memory budget in bytes, 0 if the cache is disabled
    */
-  public static get_unique_with_filter<T = TEntry>(tablename: string, filter: TEntriesFilter): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_with_filter<T>(filter);
-  }
+  private static budget: number = 0;
 
   /**
-   * Get all entries from the given table where the given field equals the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field equals the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * The estimated memory used by the cached entries in bytes
    */
-  public static get_where<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where<T>(fieldname, value);
-  }
+  private static bytes: number = 0;
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field equals the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field equals the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The frames of the clock, null for free frames
    */
-  public static get_unique_where<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where<T>(fieldname, value);
-  }
-  
+  private static frames: Array<TCacheFrame | null> = [];
+
   /**
-   * Get all entries from the given table where the given field does not equal the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field does not equal the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * The position of every cached entry in the frames, by "<table>/<id>"
    */
-  public static get_where_not<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_not<T>(fieldname, value);
-  }
+  private static positions: Map<string, number> = new Map();
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field does not equal the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The free frames, reused before the clock grows
    */
-  public static get_unique_where_not<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+  private static free_frames: Array<number> = [];
+
+  /**
+   * The position of the clock hand
+   */
+  private static hand: number = 0;
+
+  /**
+   * The feed of the changes made since the cache was enabled, null if the cache is disabled
+   */
+  private static feed: ChangeFeed | null = null;
+
+  /**
+   * The keys of the entries cached by scans, in the order they were cached. When the ring is full, a scan evicts the oldest of them
+   */
+  private static scan_ring: Array<string | null> = [];
+  private static scan_ring_position: number = 0;
+
+  /**
+   * The keys of the entries in the scan ring that have not been read by a lookup since
+   */
+  private static scanned: Set<string> = new Set();
+
+  /**
+   * The number of entries a scan can keep in the cache
+   */
+  private static readonly scan_ring_size: number = 256;
+
+  /**
+   * The number of times entries were dropped from the cache after being written or deleted, used to tell if an entry was written during an async read
+   */
+  private static generation: number = 0;
+
+  private static hits: number = 0;
+  private static misses: number = 0;
+  private static evictions: number = 0;
+
+  /**
+   * The estimated memory used by a cached entry besides its field values
+   */
+  private static readonly frame_overhead: number = 128;
+
+  /**
+   * Enable the cache, or disable it with a budget of 0
+   * @param budget The memory budget in bytes
+   * @param change_log The path to the change log of the database
+   */
+  public static configure(budget: number, change_log: string): void {
+    this.clear();
+    this.budget = budget;
+    this.feed = budget > 0 ? new ChangeFeed(0, change_log, fs.existsSync(change_log) ? fs.statSync(change_log).size : 0) : null;
+  }
+
+  /**
+   * Drop every cached entry and reset the counters
+   */
+  public static clear(): void {
+    this.frames = [];
+    this.positions = new Map();
+    this.free_frames = [];
+    this.hand = 0;
+    this.bytes = 0;
+    this.scan_ring = new Array(this.scan_ring_size).fill(null);
+    this.scan_ring_position = 0;
+    this.scanned = new Set();
+    this.hits = this.misses = this.evictions = 0;
+  }
+
+  /**
+   * Get the counters of the cache
+   */
+  public static get_stats(): TCacheStats {
+    return { budget: this.budget, bytes: this.bytes, entries: this.positions.size, hits: this.hits, misses: this.misses, evictions: this.evictions };
+  }
+
+  /**
+   * Get the keys of the cached entries to read again when the next process warms up its cache, entries read since the clock hand last passed them first.
+   * Entries only read by scans are left out
+   * @returns The "<table>/<id>" keys of the entries
+   */
+  public static get_hot_keys(): Array<string> {
+    const frames = this.frames.filter((frame: TCacheFrame | null) => frame !== null && !this.scanned.has(frame.key)) as Array<TCacheFrame>;
+    return [...frames.filter((frame: TCacheFrame) => frame.referenced), ...frames.filter((frame: TCacheFrame) => !frame.referenced)].map((frame: TCacheFrame) => frame.key);
+  }
+
+  /**
+   * Drop the entries changed since the last call from the cache, called once before each read operation
+   */
+  public static sync(): void {
+    if (!this.feed) return;
+    for (const change of this.feed.poll()) this.invalidate(change.table, change.id);
+  }
+
+  /**
+   * Get a cached entry
+   * @param scan Whether the entry is read by a scan, which does not mark the entry as recently read
+   * @returns A copy of the entry, or undefined if it is not cached
+   */
+  public static get(table: string, id: entryid, scan: boolean = false): TEntry | undefined {
+    if (!this.feed) return undefined;
+    const position = this.positions.get(`${table}/${id}`);
+    if (position === undefined) {
+      this.misses++;
+      return undefined;
+    }
+
+    const frame = this.frames[position]!;
+    if (!scan) {
+      frame.referenced = true;
+      // read by a lookup, so the entry is no longer evicted by the next scan
+      this.scanned.delete(frame.key);
+    }
+    this.hits++;
+    return { ...frame.entry };
+  }
+
+  /**
+   * Cache an entry read from its file, evicting entries that have not been read since the clock hand last passed them
+   * @param raw_length The length of the entry file
+   * @param scan Whether the entry is read by a scan, which only evicts the oldest entry cached by scans
+   */
+  public static set(table: string, id: entryid, entry: TEntry, raw_length: number, scan: boolean = false): void {
+    if (!this.feed) return;
+    const key = `${table}/${id}`;
+    const bytes = raw_length * 2 + this.frame_overhead;
+    if (bytes > this.budget) return;
+
+    if (this.positions.has(key)) this.free(this.positions.get(key)!);
+    if (scan) {
+      const oldest = this.scan_ring[this.scan_ring_position];
+      if (oldest !== null && this.scanned.has(oldest)) this.free(this.positions.get(oldest)!);
+      this.scan_ring[this.scan_ring_position] = key;
+      this.scan_ring_position = (this.scan_ring_position + 1) % this.scan_ring_size;
+      this.scanned.add(key);
+    }
+
+    while (this.bytes + bytes > this.budget) this.evict_next();
+
+    const position = this.free_frames.pop() ?? this.frames.length;
+    this.frames[position] = { key, entry: { ...entry }, bytes, referenced: false };
+    this.positions.set(key, position);
+    this.bytes += bytes;
+  }
+
+  /**
+   * Get the number of times entries were dropped from the cache after being written or deleted
+   */
+  public static get_generation(): number {
+    return this.generation;
+  }
+
+  /**
+   * Drop an entry from the cache, after it is written or deleted
+   */
+  public static invalidate(table: string, id: entryid): void {
+    this.generation++;
+    const key = `${table}/${id}`;
+    const position = this.positions.get(key);
+    if (position === undefined) return;
+    this.free(position);
+  }
+
+  /**
+   * Move the clock hand until it evicts an entry
+   */
+  private static evict_next(): void {
+    while (true) {
+      if (this.hand >= this.frames.length) this.hand = 0;
+      const frame = this.frames[this.hand];
+      if (frame && frame.referenced) frame.referenced = false;
+      else if (frame) {
+        this.free(this.hand);
+        this.evictions++;
+        return;
+      }
+      this.hand++;
+    }
+  }
+
+  /**
+   * Free a frame of the clock
+   */
+  private static free(position: number): void {
+    const frame = this.frames[position]!;
+    this.positions.delete(frame.key);
+    this.scanned.delete(frame.key);
+    this.bytes -= frame.bytes;
+    this.frames[position] = null;
+    this.free_frames.push(position);
+  }
+}
+
+/**
+ * A token bucket limiting the rate a table uses a resource at. The bucket is refilled at a fixed rate and holds at most one second of tokens,
+ * so a table that was idle can burst for a second. Tokens are always taken, and a bucket in debt delays the next use of the resource until it is paid back
+ */
+class TokenBucket {
+  /**
+   * The tokens added per second
+   */
+  public readonly rate: number;
+  private tokens: number;
+  private last_refill: number;
+
+  /**
+   * @param rate The tokens added per second
+   */
+  constructor(rate: number) {
+    this.rate = rate;
+    this.tokens = rate;
+    this.last_refill = performance.now();
+  }
+
+  /**
+   * Take tokens from the bucket, which goes into debt if it holds fewer tokens
+   */
+  public take(amount: number): void {
+    this.refill();
+    this.tokens -= amount;
+  }
+
+  /**
+   * Get how long the bucket needs to be refilled before it is no longer in debt
+   * @returns The delay in milliseconds, 0 if the bucket is not in debt
+   */
+  public get_delay(): number {
+    this.refill();
+    return this.tokens >= 0 ? 0 : -this.tokens * 1000 / this.rate;
+  }
+
+  private refill(): void {
+    const now = performance.now();
+    this.tokens = Math.min(this.rate, this.tokens + (now - this.last_refill) * this.rate / 1000);
+    this.last_refill = now;
+  }
+}
+
+/**
+ * A complete ("ph": "X") event in the Chrome trace event format, which can be opened in chrome://tracing or ui.perfetto.dev
+ */
+type TTraceEvent = {
+  readonly name: string;
+  readonly cat: string;
+
+  /**
+   * "X" for a span that ran without yielding to the event loop, "b" and "e" for the start and end of an async span
+   */
+  readonly ph: "X" | "b" | "e";
+  readonly ts: number;
+  readonly dur?: number;
+  readonly pid: number;
+  readonly tid: number;
+
+  /**
+   * The id pairing the start and end of an async span, every async span gets its own track in the trace viewer
+   */
+  readonly id?: number;
+  readonly args?: Record<string, any>;
+}
+
+/**
+ * Records timed spans of the stages of a request (catalog lookup, entry read, entry decode, predicate eval, materialization)
+ * and exports them as a Chrome trace JSON file.
+ * When tracing is disabled, Tracer.begin() and Tracer.end() only check a boolean and nothing is recorded
+ */
+class Tracer {
+  /**
+   * Whether spans are currently being recorded
+   */
+  private static enabled: boolean = false;
+
+  /**
+   * The file the recorded spans are written to when tracing is stopped
+   */
+  private static output_file: string = "";
+
+  /**
+   * The spans recorded since tracing was started
+   */
+  private static events: Array<TTraceEvent> = [];
+
+  /**
+   * The maximum amount of spans kept in memory, spans recorded past this limit are dropped and counted
+   */
+  private static readonly max_events: number = 1_000_000;
+
+  /**
+   * The amount of spans dropped because max_events was reached
+   */
+  private static dropped_events: number = 0;
+
+  /**
+   * The id of the last async span recorded
+   */
+  private static last_async_id: number = 0;
+
+  /**
+   * Start recording spans
+   * @param output_file The file to write the Chrome trace JSON to when tracing is stopped
+   * @throws Error if tracing is already started
+   */
+  public static start(output_file: string): void {
+    if (this.enabled) throw new Error("Tracing already started");
+    this.output_file = output_file;
+    this.events = [];
+    this.dropped_events = 0;
+    this.enabled = true;
+  }
+
+  /**
+   * Stop recording spans and write the recorded spans to the output file
+   * @throws Error if tracing was not previously started
+   */
+  public static stop(): void {
+    if (!this.enabled) throw new Error("Tracing not started");
+    this.enabled = false;
+    const trace = { traceEvents: this.events, displayTimeUnit: "ms", otherData: { dropped_events: this.dropped_events } };
+    fs.writeFileSync(this.output_file, JSON.stringify(trace), { encoding: 'utf8', flag: 'w' });
+    this.events = [];
+  }
+
+  /**
+   * Mark the start of a span
+   * @returns The start timestamp in microseconds, or -1 if tracing is disabled
+   */
+  public static begin(): number {
+    return this.enabled ? performance.now() * 1000 : -1;
+  }
+
+  /**
+   * Mark the end of a span and record it
+   * @param name The name of the span, e.g. "entry read"
+   * @param cat The category of the span, e.g. "storage"
+   * @param start The timestamp returned by Tracer.begin()
+   * @param args Extra information shown with the span in the trace viewer
+   */
+  public static end(name: string, cat: string, start: number, args?: Record<string, any>): void {
+    if (!this.enabled || start < 0) return;
+    if (this.events.length >= this.max_events) {
+      this.dropped_events++;
+      return;
+    }
+
+    const ts = performance.now() * 1000;
+    this.events.push({ name, cat, ph: "X", ts: start, dur: ts - start, pid: process.pid, tid: worker_threads.threadId, args });
+  }
+
+  /**
+   * Mark the end of a span that awaited, and record it as an async span. Async spans of concurrent requests overlap without nesting,
+   * so each one is shown on its own track instead of on the thread's track
+   * @param name The name of the span, e.g. "scan"
+   * @param cat The category of the span, e.g. "query"
+   * @param start The timestamp returned by Tracer.begin()
+   * @param args Extra information shown with the span in the trace viewer
+   */
+  public static end_async(name: string, cat: string, start: number, args?: Record<string, any>): void {
+    if (!this.enabled || start < 0) return;
+    if (this.events.length + 2 > this.max_events) {
+      this.dropped_events++;
+      return;
+    }
+
+    const id = ++this.last_async_id;
+    const tid = worker_threads.threadId;
+    this.events.push({ name, cat, ph: "b", ts: start, pid: process.pid, tid, id, args });
+    this.events.push({ name, cat, ph: "e", ts: performance.now() * 1000, pid: process.pid, tid, id });
+  }
+}
+
+/**
+ * Database Table
+ */
+export class Table {
+  /**
+   * The name of the table
+   */
+  public readonly name: string;
+
+  /**
+   * The paths to the folders where the table's entries are stored, one per shard.
+   * A partitioned table has a single folder, holding one folder per partition
+   */
+  private readonly folders: Array<string>;
+
+  /**
+   * The field whose value decides the shard an entry is stored in, "id" to shard by entry id
+   */
+  private readonly shard_key: fieldname;
+
+  /**
+   * The field whose value decides the partition an entry is stored in, null if the table is not partitioned.
+   * The partition holding the values from start up to start + partition_width is the "p<start>" folder inside the table's folder
+   */
+  private readonly partition_key: fieldname | null;
+
+  /**
+   * The number of partition key values each partition holds
+   */
+  private readonly partition_width: number;
+
+  /**
+   * The indexes of the table's fields, by field name
+   */
+  private readonly indexes: Map<fieldname, SecondaryIndex>;
+
+  /**
+   * The full-text indexes of the table's fields, by field name, built on the first search of each field
+   */
+  private readonly full_text_indexes: Map<fieldname, FullTextIndex> = new Map();
+
+  /**
+   * The in-memory hash indexes of the table's fields, by field name, built by Table.create_hash_index()
+   */
+  private readonly hash_indexes: Map<fieldname, HashIndex> = new Map();
+
+  /**
+   * The path to the database root folder, holding the index files of the table
+   */
+  private readonly database_folder: string;
+
+  /**
+   * The path to the change log of the database, followed by the full-text and hash indexes
+   */
+  private readonly change_log: string;
+
+  /**
+   * The id the next posted entry gets, null until the first post reads the existing ids
+   */
+  private next_id: entryid | null = null;
+
+  /**
+   * The number of entries the table had when its folders were last listed to plan a join, and when they were listed
+   */
+  private listed_count: { count: number, at: number } | null = null;
+
+  /**
+   * How long the number of entries listed to plan a join is used for before the folders are listed again
+   */
+  private static readonly listed_count_ms: number = 10_000;
+
+  /**
+   * The partition folder of every entry of a partitioned table, built when an entry is first looked up by id
+   */
+  private partition_folders: Map<entryid, string> | null = null;
+
+  /**
+   * The field holding the time an entry expires at, in milliseconds since the epoch, null if the table's entries never expire.
+   * Expired entries are hidden from reads until they are deleted by Table.expire()
+   */
+  public readonly ttl_field: fieldname | null;
+
+  /**
+   * The maximum number of entry files an async read operation reads at a time
+   */
+  private static readonly max_pending_reads: number = 64;
+
+  /**
+   * How many entries a scan reads in the time a join looks up one value in an index and reads its entries, used to choose how to run a join
+   */
+  private static readonly join_probe_cost: number = 4;
+
+  /**
+   * The token buckets of the table's I/O quota, in bytes per second, and CPU quota, in milliseconds per second. Null if the table has no such quota
+   */
+  private readonly io_bucket: TokenBucket | null;
+  private readonly cpu_bucket: TokenBucket | null;
+
+  /**
+   * The use of the table's quotas since the database was connected, see Table.get_quota_stats()
+   */
+  private readonly quota_usage = { io_bytes: 0, cpu_ms: 0, throttled: 0, throttled_ms: 0 };
+
+  /**
+   * The time the last wait for the table's quotas ends at, so concurrent async reads waiting together are counted once in quota_usage.throttled_ms
+   */
+  private throttled_until: number = 0;
+
+  /**
+   * The cell the synchronous methods wait on with Atomics.wait() while the table is throttled, which nothing ever notifies
+   */
+  private static readonly throttle_cell: Int32Array = new Int32Array(new SharedArrayBuffer(4));
+
+  /**
+   * The names of the fields in the table / in the table's entries
+   */
+  private readonly fieldnames: Array<fieldname>;
+
+  /**
+   * Whether the table belongs to a read-only database, e.g. a replica
+   */
+  private readonly read_only: boolean;
+
+  /**
+   * Whether every entry of the table has a checksum line, so an entry without one is truncated
+   */
+  private readonly checksummed: boolean;
+
+  /**
+   * Function for parsing table entries, as all fields are by default unparsed strings and might need to be converted to numbers, booleans, dates, a class instance, etc.
+   */
+  private parseFunction: TParseEntryFieldsFunction;
+
+  /**
+   * Create a table from a raw json table stored in the table.info file
+   * @important This constructor is not meant to be used directly, all tables are instantiated when the Database.connect() method is called
+   * @param raw_table The raw json table from the table.info file
+   * @param database_folder The path to the database root folder
+   * @param read_only Whether writes to the table are rejected
+   */
+  constructor(raw_table: TRawTable, database_folder: string, read_only: boolean) {
+    this.name = raw_table.name;
+    this.folders = raw_table.shards
+      ? raw_table.shards.map((root: string) => `${root.endsWith('/') ? root : root + '/'}${raw_table.name}/`)
+      : [`${database_folder}${raw_table.name}/`];
+    this.shard_key = raw_table.shard_key ?? "id";
+    this.partition_key = raw_table.partition_key ?? null;
+    this.partition_width = parseInt(raw_table.partition_width ?? "0");
+    this.ttl_field = raw_table.ttl_field ?? null;
+    this.io_bucket = parseInt(raw_table.io_quota ?? "0") > 0 ? new TokenBucket(parseInt(raw_table.io_quota!)) : null;
+    this.cpu_bucket = parseInt(raw_table.cpu_quota ?? "0") > 0 ? new TokenBucket(parseInt(raw_table.cpu_quota!)) : null;
+    this.database_folder = database_folder;
+    this.change_log = database_folder + "changes.log";
+    this.indexes = new Map((raw_table.indexes ?? []).map((fieldname: fieldname) =>
+      [fieldname, new SecondaryIndex(`${database_folder}${raw_table.name}.${fieldname}.index`, raw_table.name, fieldname, this.change_log)]));
+    this.read_only = read_only;
+    this.checksummed = raw_table.checksummed === "true";
+    this.fieldnames = raw_table.fieldnames;
+    // by default, the parseFunction will return the entry without parsing it
+    this.parseFunction = (entry: TEntry): TEntry => entry;
+  }
+
+  /**
+   * Change the parse function used to parse table entries
+   * @param parseFunction The function to use for parsing table entries, as all fields are by default unparsed strings and might need to be converted to numbers, booleans, dates, a class instance, etc.
+   * @note This will only affect the table object, not the table in the Database's memory. To update the table in the Database's memory, use the Database.set_parse_function() method
+   */
+  public set_parse_function(parseFunction: TParseEntryFieldsFunction): void {
+    this.parseFunction = parseFunction;
+  }
+
+  /**
+   * Get the filepath of the entry with the given id
+   * @param id The id of the entry to get the filepath of
+   * @returns The filepath of the entry with the given id
+   */
+  public entry_path(id: entryid): string {
+    if (this.partition_key) return (this.partition_folder_of(id) ?? this.folders[0]) + id;
+    if (this.shard_key === "id") return this.shard_folder(id.toString()) + id;
+    // the shard of an entry sharded by a field is not known from its id, so every shard is checked
+    return this.folders.map((folder: string) => folder + id).find((path: string) => fs.existsSync(path)) ?? this.folders[0] + id;
+  }
+
+  /**
+   * Get the folder of the shard an entry is stored in
+   * @param shard_key_value The value of the entry's shard key field
+   * @returns The path to the shard's folder
+   */
+  private shard_folder(shard_key_value: string): string {
+    if (this.folders.length === 1) return this.folders[0];
+    return this.folders[parseInt(crc32c(shard_key_value), 16) % this.folders.length];
+  }
+
+  /**
+   * Get the first values of the ranges of the table's partitions
+   * @returns The first value of every partition's range, in ascending order
+   * @throws Error if the table is not partitioned
+   */
+  public get_partitions(): Array<number> {
+    if (!this.partition_key) throw new Error(`Table '${this.name}' is not partitioned`);
+    if (!fs.existsSync(this.folders[0])) return [];
+    // other folders are dropped partitions that are being removed
+    return fs.readdirSync(this.folders[0]).filter((foldername: string) => /^p-?\d+$/.test(foldername))
+      .map((foldername: string) => parseInt(foldername.substring(1))).sort((a: number, b: number) => a - b);
+  }
+
+  /**
+   * Get the path to the folder of a partition
+   * @param partition_start The first value of the partition's range
+   * @returns The path to the partition's folder
+   */
+  private partition_path(partition_start: number): string {
+    return `${this.folders[0]}p${partition_start}/`;
+  }
+
+  /**
+   * Get the first value of the range of the partition holding a partition key value
+   * @param partition_key_value The value of an entry's partition key field
+   * @returns The first value of the partition's range
+   * @throws Error if the value is not a number
+   */
+  private partition_start(partition_key_value: string): number {
+    const value = parseFloat(partition_key_value);
+    if (isNaN(value)) throw new Error(`Field '${this.partition_key}' of table '${this.name}' must be a number, got '${partition_key_value}'`);
+    return Math.floor(value / this.partition_width) * this.partition_width;
+  }
+
+  /**
+   * Get the partition folder an entry is stored in
+   * @param id The id of the entry
+   * @returns The path to the entry's partition folder, or undefined if the entry does not exist
+   */
+  private partition_folder_of(id: entryid): string | undefined {
+    // no entry has been posted with this id yet
+    if (this.next_id !== null && id >= this.next_id) return undefined;
+    if (!this.partition_folders) {
+      this.partition_folders = new Map();
+      for (const folder of this.get_folders()) {
+        for (const id of this.get_ids_in(folder)) this.partition_folders.set(id, folder);
+      }
+    }
+
+    const folder = this.partition_folders.get(id);
+    if (folder && fs.existsSync(folder + id)) return folder;
+
+    // the entry does not exist, or was written by the writer in another process since the partition folders were listed
+    const found = this.get_folders().find((folder: string) => fs.existsSync(folder + id));
+    if (found) this.partition_folders.set(id, found);
+    else this.partition_folders.delete(id);
+    return found;
+  }
+
+  /**
+   * Get the folders where the table's entries are stored
+   * @returns One folder per shard of a sharded table, one folder per partition of a partitioned table
+   */
+  private get_folders(): Array<string> {
+    if (!this.partition_key) return this.folders;
+    return this.get_partitions().map((partition_start: number) => this.partition_path(partition_start));
+  }
+
+  /**
+   * Get the folders to scan for a query comparing a field with a range of values.
+   * Partitions that cannot hold a matching entry are pruned when the field is the partition key
+   * @param fieldname The name of the field compared by the query
+   * @param overlaps Whether a partition holding the values from start up to (but not including) end can hold a matching entry
+   * @returns The folders to scan
+   */
+  private prune_folders(fieldname: fieldname, overlaps: (start: number, end: number) => boolean): Array<string> {
+    if (fieldname !== this.partition_key) return this.get_folders();
+    const start = Tracer.begin();
+    const partitions = this.get_partitions();
+    const kept = partitions.filter((partition_start: number) => overlaps(partition_start, partition_start + this.partition_width));
+    Tracer.end("partition pruning", "query", start, { table: this.name, partitions: partitions.length, kept: kept.length });
+    return kept.map((partition_start: number) => this.partition_path(partition_start));
+  }
+
+  /**
+   * Get the next available id.
+   * The existing ids are only read once, as the database has a single writer (see ChangeLog)
+   * @returns The next available id
+   */
+  private get_next_id(): entryid {
+    if (this.next_id === null) {
+      const ids = this.get_all_ids();
+      this.next_id = ids.reduce((max: number, id: entryid) => Math.max(max, id), 0) + 1;
+    }
+    return this.next_id;
+  }
+
+  /**
+   * Get all existing entry ids
+   * @returns Every existing entryid
+   * @note Only files named by an id are entries, other files in the folder (e.g. temporary files of in-progress writes) are skipped
+   */
+  private get_all_ids(): Array<entryid> {
+    return this.get_folders().flatMap((folder: string) => this.get_ids_in(folder));
+  }
+
+  /**
+   * Get the ids of the entries stored in one of the table's folders
+   * @param folder The folder of one of the table's shards or partitions
+   * @returns Every entryid in the folder
+   */
+  private get_ids_in(folder: string): Array<entryid> {
+    return fs.readdirSync(folder).filter((filename: string) => /^\d+$/.test(filename)).map((id: string) => parseInt(id));
+  }
+
+  /**
+   * Check that the table can be written to
+   * @throws Error if the table belongs to a read-only database
+   */
+  private assert_writable(): void {
+    if (this.read_only) throw new Error(`Table '${this.name}' is read-only`);
+  }
+
+  /**
+   * Write entry data to file
+   * @param id The id of the entry to write to file
+   * @param data The data to write to file
+   * @param current_path The path to the entry's current file if it is known, to avoid looking up an entry that might move to another shard or partition.
+   * null for a new entry, which has no current file to look up
+   * @throws Error if a field is missing in data or if there are too many fields in data
+   */
+  private write_to_file(id: entryid, data: TEntry, current_path?: string | null): void {
+    data['id'] = id.toString();
+    
+    let stringified_data = "";
+    for (const fieldname of this.fieldnames) {
+      const value = data[fieldname];
+      if (!value) throw new Error(`Field '${fieldname}' is missing in data`);
+      stringified_data += `${value}\n`;
+    }
+
+    if (Object.keys(data).length - 1 > this.fieldnames.length) throw new Error(`Too many fields in data`);
+    this.throttle();
+    const start = Tracer.begin();
+    // the last line of the entry file is the checksum of the field lines above it, verified when the entry is read
+    const contents = stringified_data + `crc32c:${crc32c(stringified_data.substring(0, stringified_data.length - 1))}`;
+    this.charge_io(contents.length);
+    // an entry sharded or partitioned by a field moves to another shard or partition when the field changes
+    const folder = this.partition_key
+      ? this.partition_path(this.partition_start(data[this.partition_key]))
+      : this.shard_folder(this.shard_key === "id" ? id.toString() : data[this.shard_key]);
+    const previous_path = this.shard_key === "id" && !this.partition_key ? null : current_path === undefined ? this.entry_path(id) : current_path;
+    if (this.partition_key && !fs.existsSync(folder)) fs.mkdirSync(folder, { recursive: true });
+    // the entry is written to a temporary file which then replaces the entry file,
+    // so the entry file is never modified in place and snapshots can hard-link it
+    const temp_path = `${folder}.${id}.tmp`;
+    fs.writeFileSync(temp_path, contents, { encoding: 'utf8', flag: 'w' });
+    fs.renameSync(temp_path, folder + id);
+    if (previous_path && previous_path !== folder + id && fs.existsSync(previous_path)) fs.unlinkSync(previous_path);
+    EntryCache.invalidate(this.name, id);
+    this.partition_folders?.set(id, folder);
+    Tracer.end("entry write", "storage", start, { table: this.name, id });
+  }
+
+  /**
+   * Get an entry
+   * @param id The id of the entry to get
+   * @returns The entry with the given id if it exists, otherwise null
+   */
+  public get<T = TEntry>(id: entryid): T | null {
+    const record = this.get_unparsed(id);
+    return record ? this.parseFunction(record) : null;
+  }
+
+  /**
+   * Get an entry without blocking the event loop while its file is read
+   * @param id The id of the entry to get
+   * @returns The entry with the given id if it exists, otherwise null
+   */
+  public async get_async<T = TEntry>(id: entryid): Promise<T | null> {
+    EntryCache.sync();
+    const record = await this.read_entry_async(id, this.entry_path(id));
+    return record && !this.is_expired(record) ? this.parseFunction(record) : null;
+  }
+
+  /**
+   * Get an entry without parsing it using the table's parseFunction
+   * @param id The id of the entry to get
+   * @returns The entry with the given id if it exists and has not expired, otherwise null
+   * @throws Error if the entry file is truncated or its checksum does not match its contents
+   */
+  public get_unparsed(id: entryid): TEntry | null {
+    EntryCache.sync();
+    const entry = this.read_entry(id, this.entry_path(id));
+    return entry && !this.is_expired(entry) ? entry : null;
+  }
+
+  /**
+   * Check if an entry has expired and is waiting to be deleted by Table.expire()
+   * @param entry The unparsed entry
+   * @param now The current time in milliseconds since the epoch
+   * @returns true if the table has a TTL field and the entry's expiry time has passed
+   */
+  private is_expired(entry: TEntry, now: number = Date.now()): boolean {
+    return this.ttl_field !== null && parseFloat(entry[this.ttl_field]) <= now;
+  }
+
+  /**
+   * Read and verify an entry file without parsing the entry using the table's parseFunction
+   * @param id The id of the entry to read
+   * @param path The path to the entry file
+   * @param scan Whether the entry is read by a scan of the table, which must not evict the entries cached for lookups
+   * @returns The entry if the file exists, otherwise null
+   * @throws Error if the entry file is truncated or its checksum does not match its contents
+   */
+  private read_entry(id: entryid, path: string, scan: boolean = false): TEntry | null {
+    const cached = EntryCache.get(this.name, id, scan);
+    if (cached) return cached;
+
+    this.throttle();
+    const start = Tracer.begin();
+    if (!fs.existsSync(path)) return null;
+
+    const raw_entry = fs.readFileSync(path, { encoding: 'utf8', flag: 'r' });
+    this.charge_io(raw_entry.length);
+    Tracer.end("entry read", "storage", start, { table: this.name, id });
+    const record = this.decode_entry(id, raw_entry);
+    EntryCache.set(this.name, id, record, raw_entry.length, scan);
+    return record;
+  }
+
+  /**
+   * Read and verify an entry file without blocking the event loop while the file is read
+   * @param id The id of the entry to read
+   * @param path The path to the entry file
+   * @param scan Whether the entry is read by a scan of the table, which must not evict the entries cached for lookups
+   * @returns The entry if the file exists, otherwise null
+   * @throws Error if the entry file is truncated or its checksum does not match its contents
+   */
+  private async read_entry_async(id: entryid, path: string, scan: boolean = false): Promise<TEntry | null> {
+    const cached = EntryCache.get(this.name, id, scan);
+    if (cached) return cached;
+
+    await this.throttle_async();
+    const generation = EntryCache.get_generation();
+    const start = Tracer.begin();
+    let raw_entry: string;
+    try {
+      raw_entry = await fs.promises.readFile(path, { encoding: 'utf8', flag: 'r' });
+    } catch (err: any) {
+      if (err.code === 'ENOENT') return null;
+      throw err;
+    }
+    this.charge_io(raw_entry.length);
+    Tracer.end_async("entry read", "storage", start, { table: this.name, id });
+
+    // an entry written while the file was read may have been read as it was before, so it is only cached if no entry was written since
+    const record = this.decode_entry(id, raw_entry);
+    if (EntryCache.get_generation() === generation) EntryCache.set(this.name, id, record, raw_entry.length, scan);
+    return record;
+  }
+
+  /**
+   * Read and verify entry files without blocking the event loop, with at most Table.max_pending_reads files read at a time
+   * @param entries The id and path of every entry to read
+   * @param scan Whether the entries are read by a scan of the table
+   * @returns The entries in the given order, null for the entries whose file does not exist
+   * @throws Error if an entry file is truncated or its checksum does not match its contents
+   */
+  private async read_entries_async(entries: Array<[entryid, string]>, scan: boolean = false): Promise<Array<TEntry | null>> {
+    const result: Array<TEntry | null> = new Array(entries.length);
+    let next = 0;
+    const read_next = async (): Promise<void> => {
+      for (let i = next++; i < entries.length; i = next++) result[i] = await this.read_entry_async(entries[i][0], entries[i][1], scan);
+    };
+    await Promise.all(Array.from({ length: Math.min(Table.max_pending_reads, entries.length) }, read_next));
+    return result;
+  }
+
+  /**
+   * Verify the contents of an entry file and split them into the entry's fields
+   * @param id The id of the entry
+   * @param raw_entry The contents of the entry file
+   * @returns The entry
+   * @throws Error if the entry file is truncated or its checksum does not match its contents
+   */
+  private decode_entry(id: entryid, raw_entry: string): TEntry {
+    const start = Tracer.begin();
+    const cpu_start = this.cpu_bucket ? performance.now() : 0;
+    const entries = raw_entry.split('\n');
+    if (entries.length < this.fieldnames.length) {
+      throw new Error(`Entry '${id}' in table '${this.name}' is truncated: found ${entries.length} of ${this.fieldnames.length} fields`);
+    }
+
+    if (entries.length === this.fieldnames.length && this.checksummed) {
+      throw new Error(`Entry '${id}' in table '${this.name}' is truncated: its checksum line is missing`);
+    }
+
+    // entries written before checksums were added have no checksum line
+    if (entries.length > this.fieldnames.length) {
+      const stored_checksum = entries[this.fieldnames.length].substring("crc32c:".length);
+      const checksum = crc32c(raw_entry.substring(0, raw_entry.lastIndexOf('\n')));
+      if (stored_checksum !== checksum) throw new Error(`Entry '${id}' in table '${this.name}' is corrupted: checksum is ${checksum}, expected ${stored_checksum}`);
+    }
+
+    let record: TEntry = {};
+    for (let i = 0; i < this.fieldnames.length; i++) {
+      record[this.fieldnames[i]] = entries[i];
+    }
+
+    if (this.cpu_bucket) this.charge_cpu(performance.now() - cpu_start);
+    Tracer.end("entry decode", "storage", start, { table: this.name, id });
+    return record;
+  }
+
+  /**
+   * Charge the bytes of an entry file read or written to the table's I/O quota
+   */
+  private charge_io(bytes: number): void {
+    this.quota_usage.io_bytes += bytes;
+    this.io_bucket?.take(bytes);
+  }
+
+  /**
+   * Charge the milliseconds spent processing entries to the table's CPU quota
+   */
+  private charge_cpu(ms: number): void {
+    this.quota_usage.cpu_ms += ms;
+    this.cpu_bucket!.take(ms);
+  }
+
+  /**
+   * Get how long the table has to wait before it reads or writes an entry file, for its quotas to be paid back
+   * @returns The delay in milliseconds, 0 if the table is within its quotas or has none
+   */
+  public get_throttle_delay(): number {
+    return Math.max(this.io_bucket?.get_delay() ?? 0, this.cpu_bucket?.get_delay() ?? 0);
+  }
+
+  /**
+   * Count a wait for the table's quotas in the table's quota usage
+   * @param delay How long the wait lasts in milliseconds
+   */
+  private count_throttle(delay: number): void {
+    const now = performance.now();
+    this.quota_usage.throttled++;
+    this.quota_usage.throttled_ms += Math.max(0, now + delay - Math.max(now, this.throttled_until));
+    this.throttled_until = Math.max(this.throttled_until, now + delay);
+  }
+
+  /**
+   * Wait until the table is within its quotas, blocking the thread. Used before every entry file is read or written.
+   * The main thread does not wait, as blocking it would stall its event loop: its reads and writes are still charged to the quotas,
+   * which the async methods and the database server wait for
+   */
+  private throttle(): void {
+    const delay = this.get_throttle_delay();
+    if (delay === 0 || worker_threads.isMainThread) return;
+
+    const start = Tracer.begin();
+    this.count_throttle(delay);
+    Atomics.wait(Table.throttle_cell, 0, 0, delay);
+    Tracer.end("throttle", "storage", start, { table: this.name, delay });
+  }
+
+  /**
+   * Wait until the table is within its quotas without blocking the event loop
+   */
+  private async throttle_async(): Promise<void> {
+    const delay = this.get_throttle_delay();
+    if (delay === 0) return;
+
+    const start = Tracer.begin();
+    this.count_throttle(delay);
+    await new Promise((resolve) => setTimeout(resolve, delay));
+    Tracer.end_async("throttle", "storage", start, { table: this.name, delay });
+  }
+
+  /**
+   * Get the quotas of the table and how much of them it used
+   * @returns The counters, or null if the table has no quotas
+   */
+  public get_quota_stats(): TQuotaStats | null {
+    if (!this.io_bucket && !this.cpu_bucket) return null;
+    return { io_quota: this.io_bucket?.rate ?? 0, cpu_quota: this.cpu_bucket?.rate ?? 0, ...this.quota_usage };
+  }
+
+  /**
+   * Create a new entry
+   * @param data The entry's data
+   * @returns The created entry
+   */
+  public post(data: TEntry): TEntry {
+    return this.parseFunction(this.post_unparsed(data));
+  }
+
+  /**
+   * Create a new entry without parsing it using the table's parseFunction
+   * @param data The entry's data
+   * @returns The created entry, as it is stored
+   */
+  public post_unparsed(data: TEntry): TEntry {
+    this.assert_writable();
+    return WriteFreeze.run(() => {
+      const [id, fields] = this.write_new_entry(data);
+      ChangeLog.append(this.name, id, "post", fields);
+      return data;
+    });
+  }
+
+  /**
+   * Write a new entry under the next id, without publishing it to the change log
+   * @param data The entry's data, given the id of the entry
+   * @returns The id of the entry and its fields, to publish to the change log
+   * @throws Error if a field is missing in data or if there are too many fields in data
+   */
+  private write_new_entry(data: TEntry): [entryid, TEntry] {
+    const id = this.get_next_id();
+    this.write_to_file(id, data, null);
+    this.next_id = id + 1;
+
+    const fields: TEntry = {};
+    for (const fieldname of this.fieldnames) fields[fieldname] = data[fieldname];
+    return [id, fields];
+  }
+
+  /**
+   * Create several new entries, publishing them to the change log with a single write
+   * @param entries The data of each entry
+   * @returns The created entries
+   * @throws Error if a field is missing in the data of an entry or if there are too many fields, the entries before it are still created
+   */
+  public post_many(entries: Array<TEntry>): Array<TEntry> {
+    this.assert_writable();
+    const posted: Array<[entryid, TEntry]> = [];
+    WriteFreeze.run(() => {
+      try {
+        for (const data of entries) posted.push(this.write_new_entry(data));
+      } finally {
+        ChangeLog.append_all(this.name, "post", posted);
+      }
+    });
+    return entries.map((data: TEntry) => this.parseFunction(data));
+  }
+
+  /**
+   * Create several new entries, waiting for the table's quotas without blocking the event loop, without parsing the entries.
+   * Used by DatabaseServer for bulk writes. The entries are published to the change log with a single write,
+   * except that the entries created before each wait are published before it, so a change made to them meanwhile comes after them in the log.
+   * Writes may be frozen during a wait, the entries created before it are then in the snapshot or backup and the others are not
+   * @param entries The data of each entry
+   * @returns The created entries, as they are stored
+   * @throws Error if a field is missing in the data of an entry or if there are too many fields, the entries before it are still created
+   */
+  public async post_many_unparsed_async(entries: Array<TEntry>): Promise<Array<TEntry>> {
+    this.assert_writable();
+    const posted: Array<[entryid, TEntry]> = [];
+    let published = 0;
+    await WriteFreeze.begin_async();
+    let writing = true;
+    try {
+      for (const data of entries) {
+        if (this.get_throttle_delay() > 0) {
+          ChangeLog.append_all(this.name, "post", posted.slice(published));
+          published = posted.length;
+          WriteFreeze.end();
+          writing = false;
+          await this.throttle_async();
+          await WriteFreeze.begin_async();
+          writing = true;
+        }
+        posted.push(this.write_new_entry(data));
+      }
+    } finally {
+      ChangeLog.append_all(this.name, "post", posted.slice(published));
+      if (writing) WriteFreeze.end();
+    }
+    return entries;
+  }
+  
+  /**
+   * Update an entry
+   * @param id The id of the entry to update
+   * @param updated_fields Record containing the fields to update
+   * @returns The updated entry
+   * @throws Error if the entry does not exist
+   */
+  public patch(id: entryid, updated_fields: TEntry): TEntry {
+    return this.parseFunction(this.patch_unparsed(id, updated_fields));
+  }
+
+  /**
+   * Update an entry without parsing it using the table's parseFunction
+   * @param id The id of the entry to update
+   * @param updated_fields Record containing the fields to update
+   * @returns The updated entry, as it is stored
+   * @throws Error if the entry does not exist
+   */
+  public patch_unparsed(id: entryid, updated_fields: TEntry): TEntry {
+    this.assert_writable();
+    return WriteFreeze.run(() => {
+      EntryCache.sync();
+      const path = this.entry_path(id);
+      const entry = this.read_entry(id, path);
+      if (!entry || this.is_expired(entry)) throw new Error(`Entry with id '${id}' does not exist`);
+      return this.patch_entry({ id, path, entry }, updated_fields);
+    });
+  }
+
+  /**
+   * Update an entry that has already been read
+   * @param stored The entry as read from its file
+   * @param updated_fields Record containing the fields to update
+   * @returns The updated entry, unparsed
+   */
+  private patch_entry(stored: TStoredEntry, updated_fields: TEntry): TEntry {
+    this.assert_writable();
+    const updated_data = { ...stored.entry, ...updated_fields };
+    // a patch that changes nothing is neither written nor published to the change log
+    if (Object.keys(updated_fields).every((fieldname: fieldname) => stored.entry[fieldname] === updated_fields[fieldname])) return updated_data;
+
+    this.write_to_file(stored.id, updated_data, stored.path);
+    ChangeLog.append(this.name, stored.id, "patch", updated_fields);
+    return updated_data;
+  }
+
+  /**
+   * Delete an entry
+   * @param id The id of the entry to delete
+   * @throws Error if the entry does not exist
+   */
+  public delete(id: entryid): TEntry {
+    return this.parseFunction(this.delete_unparsed(id));
+  }
+
+  /**
+   * Delete an entry without parsing it using the table's parseFunction
+   * @param id The id of the entry to delete
+   * @returns The deleted entry, as it was stored
+   * @throws Error if the entry does not exist
+   */
+  public delete_unparsed(id: entryid): TEntry {
+    this.assert_writable();
+    return WriteFreeze.run(() => {
+      const entry = this.get_unparsed(id);
+      if (!entry) throw new Error(`Entry with id '${id}' does not exist`);
+      this.remove_entry(id, this.entry_path(id));
+      return entry;
+    });
+  }
+
+  /**
+   * Delete an entry that has already been read
+   * @param stored The entry as read from its file
+   */
+  private delete_entry(stored: TStoredEntry): void {
+    this.assert_writable();
+    this.remove_entry(stored.id, stored.path);
+  }
+
+  /**
+   * Remove an entry file and publish the deletion to the change log
+   * @param id The id of the entry to remove
+   * @param path The path to the entry file
+   */
+  private remove_entry(id: entryid, path: string): void {
+    const start = Tracer.begin();
+    fs.unlinkSync(path);
+    EntryCache.invalidate(this.name, id);
+    Tracer.end("entry unlink", "storage", start, { table: this.name, id });
+    ChangeLog.append(this.name, id, "delete", {});
+  }
+
+  /**
+   * Delete expired entries, which are hidden from reads until they are deleted.
+   * Called in the background for every table with a TTL field while the database is connected.
+   * An index or hash index of the TTL field finds the expired entries without reading the others
+   * @param batch_size The maximum number of entries to delete one by one, partitions holding only expired entries are dropped whole
+   * @returns The number of entries deleted
+   */
+  public expire(batch_size: number = 1000): number {
+    this.assert_writable();
+    if (!this.ttl_field) return 0;
+    return WriteFreeze.run(() => {
+      const now = Date.now();
+      let dropped = 0, deleted = 0;
+
+      // when the table is partitioned on its TTL field, the range of a partition tells whether all of its entries have expired
+      if (this.partition_key === this.ttl_field) {
+        for (const partition_start of this.get_partitions()) {
+          if (partition_start + this.partition_width <= now) dropped += this.drop_partition(partition_start);
+        }
+      }
+
+      const start = Tracer.begin();
+      // with an index of the TTL field only the expired entries are read, they are checked again as the index is only as recent as the last lookup
+      const hash_index = this.hash_indexes.get(this.ttl_field);
+      const ids = hash_index ? hash_index.filter((value: fieldvalue) => parseFloat(value) <= now) : this.indexes.get(this.ttl_field)?.lookup("<=", now) ?? null;
+      if (ids) {
+        for (const id of ids) {
+          if (deleted >= batch_size) break;
+          const path = this.entry_path(id);
+          const entry = this.read_entry(id, path, true);
+          if (!entry || !this.is_expired(entry, now)) continue;
+          this.remove_entry(id, path);
+          deleted++;
+        }
+      } else {
+        for (const folder of this.prune_folders(this.ttl_field, (partition_start: number) => partition_start <= now)) {
+          if (deleted >= batch_size) break;
+          for (const id of this.get_ids_in(folder)) {
+            if (deleted >= batch_size) break;
+            const entry = this.read_entry(id, folder + id, true);
+            if (!entry || !this.is_expired(entry, now)) continue;
+            this.remove_entry(id, folder + id);
+            deleted++;
+          }
+        }
+      }
+      Tracer.end("expire", "storage", start, { table: this.name, dropped, deleted, indexed: ids !== null });
+      return dropped + deleted;
+    });
+  }
+
+  /**
+   * Drop the partition holding the given partition key value, deleting all of its entries at once instead of one by one.
+   * The partition's folder is renamed so its entries disappear immediately, then removed in the background
+   * @param value A value in the range of the partition to drop
+   * @returns The number of entries dropped
+   * @throws Error if the table is not partitioned
+   */
+  public drop_partition(value: number): number {
+    this.assert_writable();
+    return WriteFreeze.run(() => {
+      if (!this.partition_key) throw new Error(`Table '${this.name}' is not partitioned`);
+      const partition_start = this.partition_start(value.toString());
+      const folder = this.partition_path(partition_start);
+      if (!fs.existsSync(folder)) return 0;
+
+      const start = Tracer.begin();
+      const ids = this.get_ids_in(folder);
+      const dropped_folder = `${this.folders[0]}.p${partition_start}.dropped-${Date.now()}`;
+      fs.renameSync(folder, dropped_folder);
+      ids.forEach((id: entryid) => EntryCache.invalidate(this.name, id));
+      fs.rm(dropped_folder, { recursive: true, force: true }, () => {});
+      // the entries are published to the change log one by one, so followers such as replicas delete them as well
+      ids.forEach((id: entryid) => ChangeLog.append(this.name, id, "delete", {}));
+      Tracer.end("partition drop", "storage", start, { table: this.name, partition: partition_start, entries: ids.length });
+      return ids.length;
+    });
+  }
+
+  // *** FILTER-QUERY GET METHODS *** ///
+
+  /**
+   * Get all entries in the table
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns Every entry in the table
+   * @throws Error if the database is not connected
+   */
+  public get_all<T = TEntry>(): Array<T> {
+    return this.materialize<T>(this.get_all_unparsed());
+  }
+  
+  /**
+   * Get all entries in the table in the form of TEntry records.
+   * Used internally to allow filter-queries to be applied to the table entries before parsing them
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @param folders The folders to read the entries of, every folder of the table by default
+   * @returns Every entry in the table that has not expired, without parsing the entry
+   * @throws Error if the database is not connected
+   */
+  private get_all_unparsed(folders: Array<string> = this.get_folders()): Array<TEntry> {
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const now = Date.now();
+    // an entry deleted since its folder was listed is read as null
+    const entries = folders.flatMap((folder: string) => this.get_ids_in(folder).map((id: entryid) => this.read_entry(id, folder + id, true)))
+      .filter((entry: TEntry | null) => entry !== null && !this.is_expired(entry, now)) as Array<TEntry>;
+    Tracer.end("scan", "query", start, { table: this.name, entries: entries.length });
+    return entries;
+  }
+
+  /**
+   * Get every entry that has not expired with its id and path, without parsing the entries.
+   * Used by joins, which need every entry of the left table at once
+   * @returns Every entry in the table, as read from its file
+   */
+  private get_all_stored(): Array<TStoredEntry> {
+    EntryCache.sync();
+    const now = Date.now();
+    return this.get_folders().flatMap((folder: string) => this.get_ids_in(folder).map((id: entryid) => ({ id, path: folder + id, entry: this.read_entry(id, folder + id, true)! })))
+      .filter((stored: TStoredEntry) => stored.entry !== null && !this.is_expired(stored.entry, now));
+  }
+
+  /**
+   * Get every entry that has not expired with its id and path like Table.get_all_stored(), without blocking the event loop while the entries are read
+   * @returns Every entry in the table, as read from its file
+   */
+  private async get_all_stored_async(): Promise<Array<TStoredEntry>> {
+    EntryCache.sync();
+    const listed = this.get_folders().flatMap((folder: string) => this.get_ids_in(folder).map((id: entryid) => [id, folder + id] as [entryid, string]));
+    const entries = await this.read_entries_async(listed, true);
+    const now = Date.now();
+    return listed.map(([id, path]: [entryid, string], i: number) => ({ id, path, entry: entries[i]! }))
+      .filter((stored: TStoredEntry) => stored.entry !== null && !this.is_expired(stored.entry, now));
+  }
+
+  /**
+   * Call a function that changes entries with every entry that has not expired, as one write, see for_each_stored()
+   * @param fn The function to call with each entry, its id and the path to its file
+   */
+  private update_each_stored(fn: (stored: TStoredEntry) => void): void {
+    WriteFreeze.run(() => this.for_each_stored(fn));
+  }
+
+  /**
+   * Call a function with every entry that has not expired, reading the entries one at a time without parsing them.
+   * Used by the patch and delete methods, which change each entry right after reading it instead of holding the whole table in memory.
+   * Every folder is listed before the first entry is read, so an entry the function moves to another shard or partition is not read again
+   * @param fn The function to call with each entry, its id and the path to its file
+   */
+  private for_each_stored(fn: (stored: TStoredEntry) => void): void {
+    EntryCache.sync();
+    const now = Date.now();
+    const listed = this.get_folders().map((folder: string): [string, Array<entryid>] => [folder, this.get_ids_in(folder)]);
+    for (const [folder, ids] of listed) {
+      for (const id of ids) {
+        const entry = this.read_entry(id, folder + id, true);
+        if (entry && !this.is_expired(entry, now)) fn({ id, path: folder + id, entry });
+      }
+    }
+  }
+
+  /**
+   * Get all entries in the table that pass the given predicate, without parsing them
+   * @param predicate The predicate to apply to each of the entries
+   * @param folders The folders to scan, every folder of the table by default
+   * @returns All unparsed entries that pass the given predicate
+   */
+  private select(predicate: TEntriesFilter, folders?: Array<string>): Array<TEntry> {
+    const entries = this.get_all_unparsed(folders);
+    const start = Tracer.begin();
+    const cpu_start = this.cpu_bucket ? performance.now() : 0;
+    const result = entries.filter(predicate);
+    if (this.cpu_bucket) this.charge_cpu(performance.now() - cpu_start);
+    Tracer.end("predicate eval", "query", start, { table: this.name, scanned: entries.length, matched: result.length });
+    return result;
+  }
+
+  /**
+   * Get all entries whose field matches a comparison, without parsing them.
+   * The entries are found with the field's hash index for equality, or with its index if it has one,
+   * otherwise only the partitions that can hold matching entries are scanned
+   * @param fieldname The name of the field to compare the given value with
+   * @param comparison The comparison of the field with the value
+   * @param value The value to compare the given field with
+   * @returns All unparsed entries whose field matches the comparison
+   */
+  private select_where(fieldname: fieldname, comparison: TComparison, value: fieldvalue | number): Array<TEntry> {
+    const plan = this.plan_where(fieldname, comparison, value);
+    if (!plan.ids) return this.select(plan.predicate, plan.folders);
+
+    // the entries are checked again, as the index is only as recent as the last lookup
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const now = Date.now();
+    const result = plan.ids.map((id: entryid) => this.read_entry(id, this.entry_path(id)))
+      .filter((entry: TEntry | null) => entry !== null && !this.is_expired(entry, now) && plan.predicate(entry)) as Array<TEntry>;
+    Tracer.end("index scan", "query", start, { table: this.name, field: fieldname, ids: plan.ids.length, matched: result.length });
+    return result;
+  }
+
+  /**
+   * Get all entries whose field matches a comparison without blocking the event loop while the entries are read, without parsing them
+   * @param fieldname The name of the field to compare the given value with
+   * @param comparison The comparison of the field with the value
+   * @param value The value to compare the given field with
+   * @returns All unparsed entries whose field matches the comparison
+   */
+  private async select_where_async(fieldname: fieldname, comparison: TComparison, value: fieldvalue | number): Promise<Array<TEntry>> {
+    const plan = this.plan_where(fieldname, comparison, value);
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const entries = plan.ids
+      ? await this.read_entries_async(plan.ids.map((id: entryid) => [id, this.entry_path(id)]))
+      : await this.read_entries_async(plan.folders.flatMap((folder: string) => this.get_ids_in(folder).map((id: entryid) => [id, folder + id] as [entryid, string])), true);
+    const now = Date.now();
+    const result = entries.filter((entry: TEntry | null) => entry !== null && !this.is_expired(entry, now) && plan.predicate(entry)) as Array<TEntry>;
+    Tracer.end_async(plan.ids ? "index scan" : "scan", "query", start, { table: this.name, field: fieldname, entries: entries.length, matched: result.length });
+    return result;
+  }
+
+  /**
+   * Get all entries in the table that pass the given predicate without blocking the event loop while the entries are read, without parsing them
+   * @param predicate The predicate to apply to each of the entries
+   * @returns All unparsed entries that pass the given predicate
+   */
+  private async select_async(predicate: TEntriesFilter): Promise<Array<TEntry>> {
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const entries = await this.read_entries_async(this.get_folders().flatMap((folder: string) => this.get_ids_in(folder).map((id: entryid) => [id, folder + id] as [entryid, string])), true);
+    const now = Date.now();
+    const cpu_start = this.cpu_bucket ? performance.now() : 0;
+    const result = entries.filter((entry: TEntry | null) => entry !== null && !this.is_expired(entry, now) && predicate(entry)) as Array<TEntry>;
+    if (this.cpu_bucket) this.charge_cpu(performance.now() - cpu_start);
+    Tracer.end_async("scan", "query", start, { table: this.name, entries: entries.length, matched: result.length });
+    return result;
+  }
+
+  /**
+   * Decide how to find the entries whose field matches a comparison: with the field's hash index for equality, or with its index if it has one,
+   * otherwise by scanning only the partitions that can hold matching entries
+   * @param fieldname The name of the field to compare the given value with
+   * @param comparison The comparison of the field with the value
+   * @param value The value to compare the given field with
+   * @returns The predicate matching entries pass, and either the ids of the entries found with an index or the folders to scan
+   */
+  private plan_where(fieldname: fieldname, comparison: TComparison, value: fieldvalue | number): { predicate: TEntriesFilter, ids: Array<entryid> | null, folders: Array<string> } {
+    const number = typeof value === "number" ? value : parseFloat(value);
+    const predicates: Record<TComparison, TEntriesFilter> = {
+      "==": (entry: TEntry) => entry[fieldname] === value,
+      ">": (entry: TEntry) => parseFloat(entry[fieldname]) > number,
+      "<": (entry: TEntry) => parseFloat(entry[fieldname]) < number,
+      ">=": (entry: TEntry) => parseFloat(entry[fieldname]) >= number,
+      "<=": (entry: TEntry) => parseFloat(entry[fieldname]) <= number,
+    };
+
+    const hash_index = comparison === "==" ? this.hash_indexes.get(fieldname) : undefined;
+    const ids = hash_index ? hash_index.lookup(String(value)) : this.indexes.get(fieldname)?.lookup(comparison, value);
+    if (ids) return { predicate: predicates[comparison], ids, folders: [] };
+
+    return {
+      predicate: predicates[comparison],
+      ids: null,
+      folders: this.prune_folders(fieldname, (start: number, end: number) => {
+        if (comparison === "==") return start <= number && number < end;
+        return comparison === ">" || comparison === ">=" ? end > number : comparison === "<" ? start < number : start <= number;
+      }),
+    };
+  }
+
+  /**
+   * Read a field of every entry to build an in-memory index of the field
+   * @param fieldname The name of the field to read
+   * @returns The id and field value of every entry, and a feed of the changes made since the scan started
+   */
+  private scan_field(fieldname: fieldname): [Array<[entryid, fieldvalue]>, ChangeFeed] {
+    // changes made while the table is read are applied again from the change log, which gives the same result
+    const offset = fs.existsSync(this.change_log) ? fs.statSync(this.change_log).size : 0;
+    const entries: Array<[entryid, fieldvalue]> = [];
+    for (const folder of this.get_folders()) {
+      for (const id of this.get_ids_in(folder)) {
+        const entry = this.read_entry(id, folder + id, true);
+        if (entry) entries.push([id, entry[fieldname]]);
+      }
+    }
+    return [entries, new ChangeFeed(0, this.change_log, offset)];
+  }
+
+  /**
+   * Keep a hash index of a field in memory, so get_where and get_unique_where on the field find their entries without a scan.
+   * The index is loaded from its image file if an earlier process saved one, otherwise it is built from a scan of the table,
+   * and it lasts until the database is disconnected.
+   * Together with the entry cache (the cache_size parameter of Database.connect()), lookups by the field are served from memory
+   * @param fieldname The name of the field to index
+   * @throws Error if the field does not exist
+   * @throws Error if the database has no change log to keep the index up to date, e.g. a replica
+   */
+  public create_hash_index(fieldname: fieldname): void {
+    if (!this.fieldnames.includes(fieldname)) throw new Error(`Field '${fieldname}' does not exist in table '${this.name}'`);
+    if (this.read_only && !fs.existsSync(this.change_log)) throw new Error(`Table '${this.name}' has no change log to keep a hash index up to date`);
+    if (this.hash_indexes.has(fieldname)) return;
+
+    let start = Tracer.begin();
+    const file = `${this.database_folder}${this.name}.${fieldname}.hash`;
+    const image = HashIndex.load(file, this.name, fieldname, this.change_log);
+    if (image) {
+      this.hash_indexes.set(fieldname, image);
+      Tracer.end("hash index load", "index", start, { table: this.name, field: fieldname });
+      return;
+    }
+
+    const [entries, feed] = this.scan_field(fieldname);
+    const index = new HashIndex(this.name, fieldname, entries, feed);
+    this.hash_indexes.set(fieldname, index);
+    Tracer.end("hash index build", "index", start, { table: this.name, field: fieldname, entries: entries.length });
+    if (!this.read_only) index.save(file);
+  }
+
+  /**
+   * Save the hash indexes of the table to their image files, so the next process catches up from now instead of from when they were built.
+   * Called when the database is disconnected
+   */
+  public save_hash_indexes(): void {
+    if (this.read_only) return;
+    for (const [fieldname, index] of this.hash_indexes) index.save(`${this.database_folder}${this.name}.${fieldname}.hash`);
+  }
+
+  /**
+   * Search a field for words, ranking the entries by how well they match.
+   * The first search of a field reads the whole table to build the field's full-text index, later searches only read the results
+   * @param fieldname The name of the field to search
+   * @param query The words to search for, matched without regard to case or accents
+   * @param k The maximum number of entries to return
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The k entries that best match the query, best match first
+   * @throws Error if the field does not exist
+   */
+  public search<T = TEntry>(fieldname: fieldname, query: string, k: number = 10): Array<T> {
+    if (!this.fieldnames.includes(fieldname)) throw new Error(`Field '${fieldname}' does not exist in table '${this.name}'`);
+    let index = this.full_text_indexes.get(fieldname);
+    if (!index) {
+      const start = Tracer.begin();
+      const [entries, feed] = this.scan_field(fieldname);
+      index = new FullTextIndex(this.name, fieldname, entries, feed);
+      this.full_text_indexes.set(fieldname, index);
+      Tracer.end("full-text index build", "index", start, { table: this.name, field: fieldname, entries: entries.length });
+    }
+
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const now = Date.now();
+    const result: Array<TEntry> = [];
+    // expired entries are skipped, so more matches are ranked until k entries are found or every match has been read.
+    // The ranking is deterministic, so the best matches of a larger search start with the matches already read
+    let ranked: Array<{ id: entryid, score: number }> = [];
+    for (let limit = k, read = 0; result.length < k && read === ranked.length; limit *= 2) {
+      ranked = index.search(query, limit);
+      if (read === ranked.length) break;
+      for (; read < ranked.length && result.length < k; read++) {
+        const entry = this.read_entry(ranked[read].id, this.entry_path(ranked[read].id));
+        if (entry && !this.is_expired(entry, now)) result.push(entry);
+      }
+    }
+    Tracer.end("full-text search", "query", start, { table: this.name, field: fieldname, ranked: ranked.length, returned: result.length });
+    return this.materialize<T>(result);
+  }
+
+  /**
+   * Parse the given entries using the table's parseFunction
+   * @param entries The unparsed entries
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The parsed entries
+   */
+  private materialize<T = TEntry>(entries: Array<TEntry>): Array<T> {
+    const start = Tracer.begin();
+    const result = entries.map((entry: TEntry) => this.parseFunction(entry));
+    Tracer.end("materialize", "query", start, { table: this.name, entries: entries.length });
+    return result;
+  }
+
+  /**
+   * Get all entries that pass the given filter
+   * @param filter The filter to apply to each of the entries
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries that pass the given filter
+   * @throws Error if the database is not connected
+   */
+  public get_with_filter<T = TEntry>(filter: TEntriesFilter): Array<T> {
+    return this.materialize<T>(this.select(filter));
+  }
+
+  /**
+   * Assuming there is only one entry could/does th matches the search, get the entry that passes the given filter
+   * @param filter The filter to apply to each of the entries
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries that pass the given filter
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_with_filter<T = TEntry>(filter: TEntriesFilter): T | null {
+    const result = this.select(filter);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is equal to the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select_where(fieldname, "==", value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is equal to the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select_where(fieldname, "==", value);
+    if (result.length === 0) return null;
+    if (result.length > 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is not equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is not equal to the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_not<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select((entry: TEntry) => entry[fieldname] !== value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is not equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is not equal to the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_not<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select((entry: TEntry) => entry[fieldname] !== value);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is greater than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is greater than the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_gt<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
+    return this.materialize<T>(this.select_where(fieldname, ">", value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is greater than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is greater than the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_gt<T = TEntry>(fieldname: fieldname, value: number): T | null {
+    const result = this.select_where(fieldname, ">", value);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is less than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is less than the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_lt<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
+    return this.materialize<T>(this.select_where(fieldname, "<", value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is less than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is less than the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_lt<T = TEntry>(fieldname: fieldname, value: number): T | null {
+    const result = this.select_where(fieldname, "<", value);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is greater than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is greater than or equal to the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_gte<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
+    return this.materialize<T>(this.select_where(fieldname, ">=", value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is greater than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is greater than or equal to the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_gte<T = TEntry>(fieldname: fieldname, value: number): T | null {
+    const result = this.select_where(fieldname, ">=", value);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field is less than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is less than or equal to the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_lte<T = TEntry>(fieldname: fieldname, value: number): Array<T> {
+    return this.materialize<T>(this.select_where(fieldname, "<=", value));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field is less than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is less than or equal to the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_lte<T = TEntry>(fieldname: fieldname, value: number): T | null {
+    const result = this.select_where(fieldname, "<=", value);
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field contains the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field contains the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_contains<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select((entry: TEntry) => entry[fieldname].includes(value)));
+  }
+  
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field contains the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field contains the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_contains<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select((entry: TEntry) => entry[fieldname].includes(value));
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field does not contain the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field does not contain the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_not_contains<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select((entry: TEntry) => !entry[fieldname].includes(value)));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field does not contain the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field does not contain the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_not_contains<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select((entry: TEntry) => !entry[fieldname].includes(value));
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field starts with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field starts with the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_starts_with<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select((entry: TEntry) => entry[fieldname].startsWith(value)));
+  }
+
+  /**
+   * Assuming there is only one entry that could/does match the search, get the entry where the given field starts with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field starts with the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_starts_with<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select((entry: TEntry) => entry[fieldname].startsWith(value));
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Get all entries where the given field ends with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field ends with the given value
+   * @throws Error if the database is not connected
+   */
+  public get_where_ends_with<T = TEntry>(fieldname: fieldname, value: string): Array<T> {
+    return this.materialize<T>(this.select((entry: TEntry) => entry[fieldname].endsWith(value)));
+  }
+
+  /**
+   * Assumes there is only one entry that could/does match the search, get the entry where the given field ends with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field ends with the given value
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public get_unique_where_ends_with<T = TEntry>(fieldname: fieldname, value: string): T | null {
+    const result = this.select((entry: TEntry) => entry[fieldname].endsWith(value));
+    if (result.length === 0) return null;
+    if (result.length >= 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  // *** ASYNC FILTER-QUERY GET METHODS *** ///
+
+  /**
+   * Get all entries in the table without blocking the event loop, reading up to Table.max_pending_reads entry files at a time
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns Every entry in the table
+   */
+  public async get_all_async<T = TEntry>(): Promise<Array<T>> {
+    return this.materialize<T>(await this.select_async(() => true));
+  }
+
+  /**
+   * Get all entries where the given field is equal to the given value, without blocking the event loop
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries where the given field is equal to the given value
+   */
+  public async get_where_async<T = TEntry>(fieldname: fieldname, value: string): Promise<Array<T>> {
+    return this.materialize<T>(await this.select_where_async(fieldname, "==", value));
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry where the given field equals the given value, without blocking the event loop
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry where the given field equals the given value, null if there is none
+   * @throws Error if more than one entry matches
+   */
+  public async get_unique_where_async<T = TEntry>(fieldname: fieldname, value: string): Promise<T | null> {
+    const result = await this.select_where_async(fieldname, "==", value);
+    if (result.length === 0) return null;
+    if (result.length > 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return this.parseFunction(result[0]);
+  }
+
+  /**
+   * Run a filter query given by the name of its Table method without blocking the event loop, without parsing the entries.
+   * Used by DatabaseServer, which sends the entries as they are stored and leaves parsing them to the client
+   * @param method get_all, or the name of a get_where or get_unique_where method
+   * @param fieldname The name of the field to compare the given value with, ignored by get_all
+   * @param value The value to compare the given field with, read as a number by the gt, lt, gte and lte methods
+   * @returns The unparsed entries returned by the method, at most one for a get_unique_where method
+   * @throws Error if the method does not exist, or if a get_unique_where method matches more than one entry
+   */
+  public async query_unparsed_async(method: string, fieldname: fieldname, value: string): Promise<Array<TEntry>> {
+    const match = method === "get_all" ? null : /^get_(unique_)?where(|_not|_gt|_lt|_gte|_lte|_contains|_not_contains|_starts_with|_ends_with)$/.exec(method);
+    if (method !== "get_all" && !match) throw new Error(`Unknown query method '${method}'`);
+
+    let result: Array<TEntry>;
+    switch (match?.[2]) {
+      case undefined: result = await this.select_async(() => true); break;
+      case "": result = await this.select_where_async(fieldname, "==", value); break;
+      case "_not": result = await this.select_async((entry: TEntry) => entry[fieldname] !== value); break;
+      case "_gt": result = await this.select_where_async(fieldname, ">", parseFloat(value)); break;
+      case "_lt": result = await this.select_where_async(fieldname, "<", parseFloat(value)); break;
+      case "_gte": result = await this.select_where_async(fieldname, ">=", parseFloat(value)); break;
+      case "_lte": result = await this.select_where_async(fieldname, "<=", parseFloat(value)); break;
+      case "_contains": result = await this.select_async((entry: TEntry) => entry[fieldname].includes(value)); break;
+      case "_not_contains": result = await this.select_async((entry: TEntry) => !entry[fieldname].includes(value)); break;
+      case "_starts_with": result = await this.select_async((entry: TEntry) => entry[fieldname].startsWith(value)); break;
+      default: result = await this.select_async((entry: TEntry) => entry[fieldname].endsWith(value)); break;
+    }
+    if (match?.[1] && result.length > 1) throw new Error(`Expected 1 entry or none, got ${result.length}. This function should only be used when it's known that only one entry will be returned.`);
+    return result;
+  }
+
+  // *** JOIN METHODS *** ///
+
+  /**
+   * Join the entries of the table to the entries of another table whose field equals their field, e.g. orders to the users they belong to.
+   * When the right table's field is the entry id or has an index or hash index, and looking up every distinct value costs less than
+   * scanning the right table, the values are looked up in the index (an index nested-loop join). Otherwise the right table is scanned
+   * into a hash table of the values (a hash join). Either way every entry file is read at most once
+   * @param fieldname The field of the table's entries holding the value to join on, "id" for the entry id
+   * @param right The table to join to
+   * @param right_fieldname The field of the right table's entries that must equal the value, the entry id by default
+   * @generic <L> <R> the types of the entries of the table and the right table - must be the same as what is returned by their parseFunction - default to TEntry
+   * @returns A row for every pair of entries whose fields are equal, in the order the table's entries are read
+   * @throws Error if a field does not exist
+   */
+  public join<L = TEntry, R = TEntry>(fieldname: fieldname, right: Table, right_fieldname: fieldname = "id"): Array<TJoinedRow<L, R>> {
+    this.check_join_fields(fieldname, right, right_fieldname);
+    const left = this.get_all_stored();
+    const start = Tracer.begin();
+    const values = new Set(left.map((stored: TStoredEntry) => Table.join_value(stored.id, stored.entry, fieldname)));
+    const strategy = right.plan_join(right_fieldname, values.size);
+    const matches = strategy === "hash" ? right.build_join(right_fieldname, values) : right.probe_join(right_fieldname, values);
+    const rows = Table.pair_join<L, R>(left, fieldname, matches, this.parseFunction, right.parseFunction);
+    Tracer.end("join", "query", start, { table: this.name, right: right.name, strategy, entries: left.length, values: values.size, rows: rows.length });
+    return rows;
+  }
+
+  /**
+   * Join the entries of the table to the entries of another table like Table.join(), without blocking the event loop while the entry files are read,
+   * without parsing the entries. Used by DatabaseServer, which sends the entries as they are stored
+   * @param fieldname The field of the table's entries holding the value to join on, "id" for the entry id
+   * @param right The table to join to
+   * @param right_fieldname The field of the right table's entries that must equal the value, the entry id by default
+   * @returns A row of unparsed entries for every pair of entries whose fields are equal, in the order the table's entries are read
+   * @throws Error if a field does not exist
+   */
+  public async join_unparsed_async(fieldname: fieldname, right: Table, right_fieldname: fieldname = "id"): Promise<Array<TJoinedRow>> {
+    this.check_join_fields(fieldname, right, right_fieldname);
+    const left = await this.get_all_stored_async();
+    const start = Tracer.begin();
+    const values = new Set(left.map((stored: TStoredEntry) => Table.join_value(stored.id, stored.entry, fieldname)));
+    const strategy = right.plan_join(right_fieldname, values.size);
+    const matches = strategy === "hash" ? await right.build_join_async(right_fieldname, values) : await right.probe_join_async(right_fieldname, values);
+    const rows = Table.pair_join<TEntry, TEntry>(left, fieldname, matches, (entry: TEntry) => entry, (entry: TEntry) => entry);
+    Tracer.end_async("join", "query", start, { table: this.name, right: right.name, strategy, entries: left.length, values: values.size, rows: rows.length });
+    return rows;
+  }
+
+  /**
+   * Check that the fields of a join exist
+   * @throws Error if a field does not exist
+   */
+  private check_join_fields(fieldname: fieldname, right: Table, right_fieldname: fieldname): void {
+    if (fieldname !== "id" && !this.fieldnames.includes(fieldname)) throw new Error(`Field '${fieldname}' does not exist in table '${this.name}'`);
+    if (right_fieldname !== "id" && !right.fieldnames.includes(right_fieldname)) throw new Error(`Field '${right_fieldname}' does not exist in table '${right.name}'`);
+  }
+
+  /**
+   * Get the value an entry is joined on
+   * @param fieldname The field holding the value, "id" for the entry id
+   */
+  private static join_value(id: entryid, entry: TEntry, fieldname: fieldname): fieldvalue {
+    return fieldname === "id" ? id.toString() : entry[fieldname];
+  }
+
+  /**
+   * Pair every left entry with the right entries found for its value, parsing each entry once
+   * @param left The left entries
+   * @param fieldname The field of the left entries holding the value to join on, "id" for the entry id
+   * @param matches The unparsed right entries of every value that has any, by value
+   * @param parse_left The function parsing the left entries
+   * @param parse_right The function parsing the right entries
+   * @returns A row for every pair, in the order of the left entries
+   */
+  private static pair_join<L, R>(left: Array<TStoredEntry>, fieldname: fieldname, matches: Map<fieldvalue, Array<TEntry>>, parse_left: (entry: TEntry) => L, parse_right: (entry: TEntry) => R): Array<TJoinedRow<L, R>> {
+    const parsed: Map<fieldvalue, Array<R>> = new Map();
+    const rows: Array<TJoinedRow<L, R>> = [];
+    for (const stored of left) {
+      const value = Table.join_value(stored.id, stored.entry, fieldname);
+      const right_entries = matches.get(value);
+      if (!right_entries) continue;
+      let right_parsed = parsed.get(value);
+      if (!right_parsed) parsed.set(value, right_parsed = right_entries.map(parse_right));
+      const entry = parse_left(stored.entry);
+      for (const right_entry of right_parsed) rows.push({ left: entry, right: right_entry });
+    }
+    return rows;
+  }
+
+  /**
+   * Choose how a join finds the entries of the table whose field equals the values of the left entries.
+   * The number of entries in the table is counted from the listing of its folders, without reading them
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param value_count The number of distinct values to find
+   * @returns "index nested-loop" if the field is indexed and looking up every value is cheaper than a scan, otherwise "hash".
+   * An index whose file does not exist cannot be looked up, so the table is scanned
+   */
+  private plan_join(fieldname: fieldname, value_count: number): TJoinStrategy {
+    if (fieldname !== "id" && !this.hash_indexes.has(fieldname) && !this.indexes.get(fieldname)?.is_available()) return "hash";
+
+    // the shard of an entry sharded by a field is not known from its id, so a lookup by id checks every shard
+    const probe_cost = Table.join_probe_cost * (fieldname === "id" && this.shard_key !== "id" ? this.folders.length : 1);
+    return value_count * probe_cost < this.count_entries(fieldname) ? "index nested-loop" : "hash";
+  }
+
+  /**
+   * Get the number of entries in the table to plan a join, without listing its folders when an index of the table knows it.
+   * Otherwise the folders are listed at most once every 10 seconds, as the plan only needs the table's size roughly
+   * @param fieldname The field of the join, whose index is asked first
+   */
+  private count_entries(fieldname: fieldname): number {
+    const count = this.hash_indexes.get(fieldname)?.size() ?? this.indexes.get(fieldname)?.size()
+      ?? [...this.hash_indexes.values()][0]?.size() ?? null;
+    if (count !== null) return count;
+
+    const now = Date.now();
+    if (!this.listed_count || now - this.listed_count.at > Table.listed_count_ms) this.listed_count = { count: this.get_all_ids().length, at: now };
+    return this.listed_count.count;
+  }
+
+  /**
+   * Look up the entries of the table whose field equals each of the values, in the field's index or by id
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param values The values to look up
+   * @returns The unparsed entries of every value that has any, by value
+   */
+  private probe_join(fieldname: fieldname, values: Set<fieldvalue>): Map<fieldvalue, Array<TEntry>> {
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const now = Date.now();
+    const matches: Map<fieldvalue, Array<TEntry>> = new Map();
+    for (const value of values) {
+      const entries = this.probe_join_ids(fieldname, value).map((id: entryid) => this.read_entry(id, this.entry_path(id)))
+        .filter((entry: TEntry | null) => this.is_join_match(entry, fieldname, value, now)) as Array<TEntry>;
+      if (entries.length) matches.set(value, entries);
+    }
+    Tracer.end("join probe", "query", start, { table: this.name, field: fieldname, values: values.size, matched: matches.size });
+    return matches;
+  }
+
+  /**
+   * Look up the entries of the table whose field equals each of the values like Table.probe_join(), without blocking the event loop
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param values The values to look up
+   * @returns The unparsed entries of every value that has any, by value
+   */
+  private async probe_join_async(fieldname: fieldname, values: Set<fieldvalue>): Promise<Map<fieldvalue, Array<TEntry>>> {
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const probes = Array.from(values, (value: fieldvalue): [fieldvalue, Array<entryid>] => [value, this.probe_join_ids(fieldname, value)]);
+    const entries = await this.read_entries_async(probes.flatMap(([, ids]) => ids.map((id: entryid) => [id, this.entry_path(id)] as [entryid, string])));
+    const now = Date.now();
+    const matches: Map<fieldvalue, Array<TEntry>> = new Map();
+    let next = 0;
+    for (const [value, ids] of probes) {
+      const found = entries.slice(next, next += ids.length).filter((entry: TEntry | null) => this.is_join_match(entry, fieldname, value, now)) as Array<TEntry>;
+      if (found.length) matches.set(value, found);
+    }
+    Tracer.end_async("join probe", "query", start, { table: this.name, field: fieldname, values: values.size, matched: matches.size });
+    return matches;
+  }
+
+  /**
+   * Get the ids of the entries whose field may equal a value, from the field's index or the value itself for the entry id.
+   * Table.plan_join() only probes a field whose hash index exists or whose index has been loaded, so the lookup always finds the index
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param value The value to look up
+   */
+  private probe_join_ids(fieldname: fieldname, value: fieldvalue): Array<entryid> {
+    if (fieldname === "id") return /^\d+$/.test(value) ? [parseInt(value)] : [];
+    return this.plan_where(fieldname, "==", value).ids!;
+  }
+
+  /**
+   * Check that an entry read by a join probe exists, has not expired and still has the value,
+   * as the index is only as recent as the last lookup
+   */
+  private is_join_match(entry: TEntry | null, fieldname: fieldname, value: fieldvalue, now: number): boolean {
+    return entry !== null && !this.is_expired(entry, now) && (fieldname === "id" || entry[fieldname] === value);
+  }
+
+  /**
+   * Scan the table into a hash table of the values of a field, keeping only the entries whose value is one of the given values
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param values The values of the left entries
+   * @returns The unparsed entries of every value that has any, by value
+   */
+  private build_join(fieldname: fieldname, values: Set<fieldvalue>): Map<fieldvalue, Array<TEntry>> {
+    const start = Tracer.begin();
+    const matches: Map<fieldvalue, Array<TEntry>> = new Map();
+    let scanned = 0;
+    this.for_each_stored((stored: TStoredEntry) => {
+      scanned++;
+      Table.add_join_match(matches, values, Table.join_value(stored.id, stored.entry, fieldname), stored.entry);
+    });
+    Tracer.end("join build", "query", start, { table: this.name, field: fieldname, entries: scanned, values: matches.size });
+    return matches;
+  }
+
+  /**
+   * Scan the table into a hash table of the values of a field like Table.build_join(), without blocking the event loop.
+   * The folders are read one at a time, so only the entries of one folder are held besides the matches
+   * @param fieldname The field of the table's entries to join on, "id" for the entry id
+   * @param values The values of the left entries
+   * @returns The unparsed entries of every value that has any, by value
+   */
+  private async build_join_async(fieldname: fieldname, values: Set<fieldvalue>): Promise<Map<fieldvalue, Array<TEntry>>> {
+    EntryCache.sync();
+    const start = Tracer.begin();
+    const matches: Map<fieldvalue, Array<TEntry>> = new Map();
+    let scanned = 0;
+    const listed = this.get_folders().map((folder: string): [string, Array<entryid>] => [folder, this.get_ids_in(folder)]);
+    for (const [folder, ids] of listed) {
+      const entries = await this.read_entries_async(ids.map((id: entryid) => [id, folder + id] as [entryid, string]), true);
+      const now = Date.now();
+      for (let i = 0; i < ids.length; i++) {
+        const entry = entries[i];
+        if (!entry || this.is_expired(entry, now)) continue;
+        scanned++;
+        Table.add_join_match(matches, values, Table.join_value(ids[i], entry, fieldname), entry);
+      }
+    }
+    Tracer.end_async("join build", "query", start, { table: this.name, field: fieldname, entries: scanned, values: matches.size });
+    return matches;
+  }
+
+  /**
+   * Add an entry to the hash table of a join build if its value is one of the values of the left entries
+   */
+  private static add_join_match(matches: Map<fieldvalue, Array<TEntry>>, values: Set<fieldvalue>, value: fieldvalue, entry: TEntry): void {
+    if (!values.has(value)) return;
+    const found = matches.get(value);
+    if (found) found.push(entry);
+    else matches.set(value, [entry]);
+  }
+
+  // *** FILTER-QUERY PATCH METHODS *** ///
+
+  /**
+   * Update all entries in the table with the values in updated_fields
+   * @param updated_fields The fields to update
+   * @warning be careful using this method
+   */
+  public patch_all(updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => this.patch_entry(stored, updated_fields));
+  }
+
+  /**
+   * Update all entries that pass the given filter
+   * @param filter The filter to apply to each of the entries
+   */
+  public patch_with_filter(filter: TEntriesFilter, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (filter(stored.entry)) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Update all entries in the table with the values in updated_fields where the given field is equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] === value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field is not equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_not(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] !== value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field is greater than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_gt(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] > value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field is less than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_lt(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] < value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field is greater than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_gte(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] >= value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field is less than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_lte(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] <= value) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field contains the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_contains(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].includes(value)) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field does not contain the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_not_contains(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (!stored.entry[fieldname].includes(value)) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field starts with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_starts_with(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].startsWith(value)) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  /**
+   * Get all entries where the given field ends with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   */
+  public patch_where_ends_with(fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].endsWith(value)) this.patch_entry(stored, updated_fields);
+    });
+  }
+
+  // *** FILTER-QUERY DELETE METHODS *** ///
+
+  /**
+   * Delete all entries
+   * @warning be careful using this method
+   */
+  public delete_all(): void {
+    this.update_each_stored((stored: TStoredEntry) => this.delete_entry(stored));
+  }
+
+  /**
+   * Delete all entries that pass the given filter
+   * @param filter The filter to apply to each of the entries
+   */
+  public delete_with_filter(filter: TEntriesFilter): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (filter({ ...stored.entry, id: stored.id.toString() })) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] === value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is not equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_not(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] !== value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is greater than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_gt(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] > value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is less than the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_lt(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] < value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is greater than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_gte(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] >= value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field is less than or equal to the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_lte(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname] <= value) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field contains the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_contains(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].includes(value)) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field does not contain the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_not_contains(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (!stored.entry[fieldname].includes(value)) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field starts with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_starts_with(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].startsWith(value)) this.delete_entry(stored);
+    });
+  }
+
+  /**
+   * Delete all entries where the given field ends with the given value
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   */
+  public delete_where_ends_with(fieldname: fieldname, value: string): void {
+    this.update_each_stored((stored: TStoredEntry) => {
+      if (stored.entry[fieldname].endsWith(value)) this.delete_entry(stored);
+    });
+  }
+}
+
+/**
+ * Static Database class for interacting with the MDBL database
+ */
+export default class Database {
+  /**
+   * The path to the database root folder
+   */
+  private static database_folder: string = "./database/";
+  
+  /**
+   * The path to the table.info file
+   */
+  private static tables_info_file: string = this.database_folder + "table.info";
+
+  /**
+   * Whether the database was connected in read-only mode
+   */
+  private static read_only: boolean = false;
+  
+  /**
+   * The tables in the database
+   */
+  private static tables: Array<Table> = [];
+
+  /**
+   * Connected status
+   */
+  private static connected: boolean = false;
+
+  /**
+   * The timer deleting the expired entries of tables with a TTL field, null if there are none or the database is read-only
+   */
+  private static expiry_timer: ReturnType<typeof setInterval> | null = null;
+
+  /**
+   * How often expired entries are deleted in the background, and the maximum number of entries deleted one by one per table each time
+   */
+  private static readonly expiry_interval_ms: number = 60_000;
+  private static readonly expiry_batch_size: number = 1000;
+
+  /**
+   * @note This method is required before calling any other methods
+   * Connect to the database,
+   * create the neccessary files if they do not exist, 
+   * and create existing tables from the table information in the file
+   * @param database_folder The path to the database root folder, ending with a slash
+   * @param read_only Reject writes to every table, used to serve reads from a replica kept up to date by the replicate_db tool
+   * @param cache_size The memory budget in bytes for keeping recently read entries in memory, shared by every table, 0 to always read entries from their files.
+   * Ignored for a replica, which is written to without a change log
+   * @throws Error if the database is already connected
+   * @throws Error if the database is connected in read-only mode and the database folder does not exist
+   */
+  public static connect(database_folder: string = "./database/", read_only: boolean = false, cache_size: number = 0): void {
+    if (this.connected) throw new Error("Database already connected");
+    this.database_folder = database_folder;
+    this.tables_info_file = database_folder + "table.info";
+    this.read_only = read_only;
+
+    if (!fs.existsSync(this.database_folder)) {
+      if (read_only) throw new Error(`Database folder '${this.database_folder}' does not exist`);
+      fs.mkdirSync(this.database_folder);
+    }
+
+    if (fs.existsSync(this.tables_info_file)) {
+      this.tables = fs.readFileSync(this.tables_info_file, { encoding: 'utf8', flag: 'r' }).split(/\r?\n/)
+        .map((line: string, index: number) => line.length != 0 ? new Table(this.parse_table_info_line(line, index + 1), this.database_folder, read_only) : null)
+        .filter((table: Table | null) => table !== null) as Array<Table>;
+    }
+
+    if (!read_only) {
+      ChangeLog.open(this.database_folder);
+      WriteFreeze.open(this.database_folder);
+    }
+    // the cache relies on the change log to drop entries changed by the writer when it runs in another process
+    const change_log = this.database_folder + "changes.log";
+    EntryCache.configure(!read_only || fs.existsSync(change_log) ? cache_size : 0, change_log);
+    if (!read_only && this.tables.some((table: Table) => table.ttl_field !== null)) {
+      this.expiry_timer = setInterval(() => this.expire_tables(), this.expiry_interval_ms);
+      // the timer does not keep the process alive
+      this.expiry_timer.unref();
+    }
+    this.connected = true;
+  }
+
+  /**
+   * Delete a batch of expired entries from every table with a TTL field, called by the expiry timer.
+   * Failures are reported as process warnings, the next run tries again
+   */
+  private static expire_tables(): void {
+    // the entries are deleted by the next run once the freeze is lifted
+    if (WriteFreeze.is_frozen()) return;
+    for (const table of this.tables) {
+      try {
+        table.expire(this.expiry_batch_size);
+      } catch (err: any) {
+        process.emitWarning(`Failed to delete expired entries of table '${table.name}': ${err.message}`);
+      }
+    }
+  }
+
+  /**
+   * Get the replication state of a replica database, connected with Database.connect(replica_folder, true)
+   * @returns The state last reported by the replicate_db tool
+   * @throws Error if the database is not connected
+   * @throws Error if the database is not a replica
+   */
+  public static get_replication_status(): TReplicationStatus {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    const state_file = this.database_folder + "replica.state";
+    if (!fs.existsSync(state_file)) throw new Error(`Database '${this.database_folder}' is not a replica`);
+
+    const state: Record<string, number> = {};
+    for (const line of fs.readFileSync(state_file, { encoding: 'utf8', flag: 'r' }).split(/\r?\n/)) {
+      const [key, value] = line.split(" ");
+      if (key) state[key] = parseInt(value);
+    }
+
+    return { applied_seq: state.applied_seq, lag_ms: state.lag_ms, updated_at: state.updated_at };
+  }
+
+  /**
+   * Parse and verify a line of the table.info file
+   * @param line The line, a JSON table record optionally ending with a "crc32c" checksum of the rest of the record
+   * @param line_number The line number, used in error messages
+   * @returns The raw json table
+   * @throws Error if the line is not valid JSON or its checksum does not match the record
+   */
+  private static parse_table_info_line(line: string, line_number: number): TRawTable {
+    const checksum_index = line.lastIndexOf(',"crc32c":"');
+    if (checksum_index !== -1) {
+      const stored_checksum = line.substring(checksum_index + ',"crc32c":"'.length, line.length - '"}'.length);
+      const checksum = crc32c(line.substring(0, checksum_index) + "}");
+      if (stored_checksum !== checksum) throw new Error(`Line ${line_number} of ${this.tables_info_file} is corrupted: checksum is ${checksum}, expected ${stored_checksum}`);
+    }
+
+    try {
+      return JSON.parse(line);
+    } catch (err: any) {
+      throw new Error(`Line ${line_number} of ${this.tables_info_file} is corrupted: ${err.message}`);
+    }
+  }
+
+  /**
+   * Disconnect from the database, saving the hash indexes and the keys of the cached entries for the next process
+   * @throws Error if the database was not previously connected
+   */
+  public static disconnect(): void {
+    if (!this.connected) throw new Error("Database not connected");
+    if (this.expiry_timer) clearInterval(this.expiry_timer);
+    this.expiry_timer = null;
+    if (!this.read_only) {
+      for (const table of this.tables) table.save_hash_indexes();
+      // an empty cache removes the keys saved by an earlier process, which warm_cache would otherwise read back
+      const keys = EntryCache.get_hot_keys();
+      if (keys.length) fs.writeFileSync(this.database_folder + "cache.keys", keys.join('\n'));
+      else if (fs.existsSync(this.database_folder + "cache.keys")) fs.unlinkSync(this.database_folder + "cache.keys");
+    }
+    ChangeLog.close();
+    WriteFreeze.close();
+    EntryCache.configure(0, "");
+    this.tables = [];
+    this.connected = false;
+  }
+
+  /**
+   * Get an existing table from the database
+   * @param tablename The name of the table to get
+   * @returns The given table
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_table(tablename: string): Table {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    const start = Tracer.begin();
+    const table = this.tables.find((table: Table) => table.name == tablename);
+    Tracer.end("catalog lookup", "catalog", start, { table: tablename });
+    if (!table) throw new Error(`Table ${tablename} does not exist`);
+    return table;
+  }
+
+  /**
+   * Read the entries that were cached when the database was last disconnected, until the cache is full.
+   * The entries read again since the clock hand last passed them come first, the other entries after them, each group in no particular order
+   * Called after Database.connect() so the first reads after a restart are served from memory
+   * @returns The number of entries read
+   * @throws Error if the database is not connected
+   */
+  public static warm_cache(): number {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    const keys_file = this.database_folder + "cache.keys";
+    if (EntryCache.get_stats().budget === 0 || !fs.existsSync(keys_file)) return 0;
+
+    const start = Tracer.begin();
+    const evictions = EntryCache.get_stats().evictions;
+    let read = 0;
+    for (const key of fs.readFileSync(keys_file, { encoding: 'utf8', flag: 'r' }).split('\n')) {
+      const table = this.tables.find((table: Table) => table.name === key.substring(0, key.lastIndexOf('/')));
+      if (!table) continue;
+      table.get_unparsed(parseInt(key.substring(key.lastIndexOf('/') + 1)));
+      // the cache is smaller than when the keys were saved, so the rest would evict the entries read so far
+      if (EntryCache.get_stats().evictions !== evictions) break;
+      read++;
+    }
+    Tracer.end("cache warmup", "catalog", start, { entries: read });
+    return read;
+  }
+
+  /**
+   * Get the counters of the entry cache, configured with the cache_size parameter of Database.connect()
+   * @returns The memory budget and use of the cache, and how many entry reads were served from it
+   * @throws Error if the database is not connected
+   */
+  public static get_cache_stats(): TCacheStats {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    return EntryCache.get_stats();
+  }
+
+  /**
+   * Get the counters of the I/O and CPU quotas of the tables, configured in the table.info file by the make_table and set_quota tools
+   * @returns The quotas of every table that has any, by table name, with the bytes and processing time each table used and how long it was throttled
+   * @throws Error if the database is not connected
+   */
+  public static get_quota_stats(): Record<string, TQuotaStats> {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    const stats: Record<string, TQuotaStats> = {};
+    for (const table of this.tables) {
+      const table_stats = table.get_quota_stats();
+      if (table_stats) stats[table.name] = table_stats;
+    }
+    return stats;
+  }
+
+  /**
+   * Get the sequence number of the last change made to the database.
+   * To follow a table, read it and then follow the changes made after this sequence number with a ChangeFeed
+   * @returns The sequence number of the last change in the change log, 0 if no changes have been made
+   * @throws Error if the database is not connected
+   */
+  public static get_last_change_seq(): number {
+    if (!this.connected) throw new Error("Database not connected - use 'Database.connect()' to connect to the database");
+    return ChangeLog.get_last_seq();
+  }
+
+  /**
+   * Start recording trace spans for every request made to the database
+   * @param output_file The file to write the trace to when Database.stop_trace() is called, e.g. "./trace.json".
+   * The file is in the Chrome trace event format and can be opened in chrome://tracing or ui.perfetto.dev
+   * @throws Error if tracing is already started
+   */
+  public static start_trace(output_file: string): void {
+    Tracer.start(output_file);
+  }
+
+  /**
+   * Stop recording trace spans and write them to the file given to Database.start_trace()
+   * @throws Error if tracing was not previously started
+   */
+  public static stop_trace(): void {
+    Tracer.stop();
+  }
+
+  /**
+   * Set the parse function for the given table
+   * @param tablename The name of the table to set the parse function for
+   * @param parseFunction The function to use to parse the entry fields
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static set_table_parse_function(tablename: string, parseFunction: TParseEntryFieldsFunction): void {
+    for (let i = 0; i < this.tables.length; i++) {
+      if (this.tables[i].name != tablename) continue;
+      return this.tables[i].set_parse_function(parseFunction);
+    }
+  }
+
+  /**
+   * Get an entry with the given id from the given table
+   * @param tablename The name of the table to get the entry from
+   * @param id The id of the entry to get
+   * @returns The entry with the given id if it exists, otherwise null
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get<T = TEntry>(tablename: string, id: entryid): T | null {
+    const table = this.get_table(tablename);
+    return table.get<T>(id);
+  }
+
+  /**
+   * Get an entry with the given id from the given table without blocking the event loop while its file is read
+   * @param tablename The name of the table to get the entry from
+   * @param id The id of the entry to get
+   * @returns The entry with the given id if it exists, otherwise null
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static async get_async<T = TEntry>(tablename: string, id: entryid): Promise<T | null> {
+    const table = this.get_table(tablename);
+    return table.get_async<T>(id);
+  }
+
+  /**
+   * Create a new entry in the given table
+   * @param tablename The name of the table to create the entry in
+   * @param data The entry data
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static post(tablename: string, data: TEntry): void {
+    const table = this.get_table(tablename);
+    table.post(data);
+  }
+
+  /**
+   * Create several new entries in the given table, publishing them to the change log with a single write
+   * @param tablename The name of the table to create the entries in
+   * @param entries The data of each entry
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static post_many(tablename: string, entries: Array<TEntry>): void {
+    const table = this.get_table(tablename);
+    table.post_many(entries);
+  }
+
+  /**
+   * Update the entry with the given id in the given table
+   * @param tablename The name of the table to update the entry in
+   * @param id The id of the entry to update
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch(tablename: string, id: entryid, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch(id, updated_fields);
+  }
+
+  /**
+   * Delete the entry with the given id from the given table
+   * @param tablename The name of the table to delete the entry from
+   * @param id The id of the entry to delete
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete(tablename: string, id: entryid): void {
+    const table = this.get_table(tablename);
+    table.delete(id);
+  }
+
+  /// *** FILTER-QUERY GET METHODS *** ///
+
+  /**
+   * Get all entries from the given table
+   * @param tablename The name of the table to get the entry from
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_all<T = TEntry>(tablename: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_all<T>();
+  }
+
+  /**
+   * Get all entries from the given table that pass the given filter
+   * @param tablename The name of the table to get the entry from 
+   * @param filter The filter to apply to the entries
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The entries that pass the given filter
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_with_filter<T = TEntry>(tablename: string, filter: TEntriesFilter): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_with_filter<T>(filter);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field passes the filter
+   * @param tablename The name of the table to get the entry from 
+   * @param filter The filter to apply to the entries
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry that passes the given filter
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_with_filter<T = TEntry>(tablename: string, filter: TEntriesFilter): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_with_filter<T>(filter);
+  }
+
+  /**
+   * Get all entries from the given table where the given field equals the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field equals the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field equals the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field equals the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where<T>(fieldname, value);
+  }
+  
+  /**
+   * Get all entries from the given table where the given field does not equal the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field does not equal the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_not<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_not<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field does not equal the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_not<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_not<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field is greater than the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field is greater than the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_gt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_gt<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is greater than the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field is greater than the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_gt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_gt<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field is less than the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field is less than the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_lt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_lt<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is less than the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field is less than the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_lt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_lt<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field is greater than or equal to the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field is greater than or equal to the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_gte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_gte<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is greater than or equal to the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field is greater than or equal to the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_gte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_gte<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field is less than or equal to the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field is less than or equal to the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_lte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_lte<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is less than or equal to the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field is less than or equal to the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_lte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_lte<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field contains the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field contains the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_contains<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field contains the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field contains the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_contains<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field does not contain the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field does not contain the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_not_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_not_contains<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field does not contain the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field does not contain the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_not_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_not_contains<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field starts with the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field starts with the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_starts_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_starts_with<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field starts with the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field starts with the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_starts_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_starts_with<T>(fieldname, value);
+  }
+
+  /**
+   * Get all entries from the given table where the given field ends with the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field ends with the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static get_where_ends_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
+    const table = this.get_table(tablename);
+    return table.get_where_ends_with<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field ends with the given value
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field ends with the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if there is not exactly one entry that passes the given filter
+   */
+  public static get_unique_where_ends_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_ends_with<T>(fieldname, value);
+  }
+
+  /// *** ASYNC FILTER-QUERY GET METHODS *** ///
+
+  /**
+   * Get all entries from the given table without blocking the event loop
+   * @param tablename The name of the table to get the entries from
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns Every entry in the table
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static async get_all_async<T = TEntry>(tablename: string): Promise<Array<T>> {
+    const table = this.get_table(tablename);
+    return table.get_all_async<T>();
+  }
+
+  /**
+   * Get all entries from the given table where the given field equals the given value, without blocking the event loop
+   * @param tablename The name of the table to get the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns All entries from the given table where the given field equals the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static async get_where_async<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Promise<Array<T>> {
+    const table = this.get_table(tablename);
+    return table.get_where_async<T>(fieldname, value);
+  }
+
+  /**
+   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field equals the given value, without blocking the event loop
+   * @param tablename The name of the table to get the entry from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The sole entry from the given table where the given field equals the given value
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   * @throws Error if more than one entry matches
+   */
+  public static async get_unique_where_async<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Promise<T | null> {
+    const table = this.get_table(tablename);
+    return table.get_unique_where_async<T>(fieldname, value);
+  }
+
+  /// *** JOIN METHODS *** ///
+
+  /**
+   * Join the entries of a table to the entries of another table whose field equals their field, e.g. orders to the users they belong to.
+   * See Table.join() for how the join is run
+   * @param tablename The name of the left table
+   * @param fieldname The field of the left table's entries holding the value to join on, "id" for the entry id
+   * @param right_tablename The name of the right table
+   * @param right_fieldname The field of the right table's entries that must equal the value, the entry id by default
+   * @generic <L> <R> the types of the entries of the two tables - must be the same as what is returned by their parseFunction - default to TEntry
+   * @returns A row for every pair of entries whose fields are equal
+   * @throws Error if a table or field does not exist
+   * @throws Error if the database is not connected
+   *
+   * @example
+   * for (const { left: order, right: user } of Database.join("Orders", "user", "Users")) console.log(user.name, order.total);
+   */
+  public static join<L = TEntry, R = TEntry>(tablename: string, fieldname: fieldname, right_tablename: string, right_fieldname: fieldname = "id"): Array<TJoinedRow<L, R>> {
+    const table = this.get_table(tablename);
+    return table.join<L, R>(fieldname, this.get_table(right_tablename), right_fieldname);
+  }
+
+  /// *** FILTER-QUERY PATCH METHODS *** ///
+
+  /**
+   * Update all entries from the given table
+   * @param tablename The name of the table to update the entries in
+   * @param updated_fields The fields to update
+   * @warning be careful using this method
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_all(tablename: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_all(updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table that pass the filter
+   * @param tablename The name of the table to update the entries in
+   * @param filter The filter to apply to the entries
+   * @param updated_fields The updated fields to apply to the entries
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_with_filter(tablename: string, filter: TEntriesFilter, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_with_filter(filter, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is equal to the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is not equal to the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_not(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_not(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is greater than the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_gt(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_gt(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is less than the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_lt(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_lt(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is greater than or equal to the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_gte(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_gte(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field is less than or equal to the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_lte(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_lte(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field contains the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_contains(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_contains(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field does not contain the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_not_contains(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_not_contains(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field starts with the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_starts_with(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_starts_with(fieldname, value, updated_fields);
+  }
+
+  /**
+   * Update all entries from the given table where the given field ends with the given value
+   * @param tablename The name of the table to update the entries in
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @param updated_fields The fields to update
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static patch_where_ends_with(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
+    const table = this.get_table(tablename);
+    table.patch_where_ends_with(fieldname, value, updated_fields);
+  }
+
+  /// *** FILTER-QUERY DELETE METHODS *** ///
+
+  /**
+   * Delete all entries from the given table
+   * @param tablename The name of the table to delete the entries from
+   * @warning be careful using this method 
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_all(tablename: string): void {
+    const table = this.get_table(tablename);
+    table.delete_all();
+  }
+
+  /**
+   * Delete all entries from the given table that pass the given filter
+   * @param tablename The name of the table to delete the entries from
+   * @param filter The filter to apply to the table
+   */
+  public static delete_with_filter(tablename: string, filter: TEntriesFilter): void {
+    const table = this.get_table(tablename);
+    table.delete_with_filter(filter);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is equal to the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is not equal to the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_not(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_not(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is greater than the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_gt(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_gt(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is greater than or equal to the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_gte(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_gte(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is less than the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_lt(tablename: string, fieldname: fieldname, value: string): void {
     const table = this.get_table(tablename);
-    return table.get_unique_where_not<T>(fieldname, value);
+    table.delete_where_lt(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field is less than or equal to the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_lte(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_lte(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field contains the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_contains(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_contains(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field does not contain the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_not_contains(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_not_contains(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field starts with the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_starts_with(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_starts_with(fieldname, value);
+  }
+
+  /**
+   * Delete all entries from the given table where the given field ends with the given value
+   * @param tablename The name of the table to delete the entries from
+   * @param fieldname The name of the field to compare the given value with
+   * @param value The value to compare the given field with
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static delete_where_ends_with(tablename: string, fieldname: fieldname, value: string): void {
+    const table = this.get_table(tablename);
+    table.delete_where_ends_with(fieldname, value);
+  }
+
+  /**
+   * Drop the partition of a partitioned table holding the given partition key value, deleting all of its entries at once
+   * @param tablename The name of the table to drop the partition of
+   * @param value A value in the range of the partition to drop
+   * @returns The number of entries dropped
+   * @throws Error if the table does not exist or is not partitioned
+   * @throws Error if the database is not connected
+   */
+  public static drop_partition(tablename: string, value: number): number {
+    const table = this.get_table(tablename);
+    return table.drop_partition(value);
+  }
+
+  /**
+   * Delete the expired entries of the given table now instead of waiting for them to be deleted in the background
+   * @param tablename The name of the table to delete the expired entries of
+   * @param batch_size The maximum number of entries to delete one by one
+   * @returns The number of entries deleted
+   * @throws Error if the table does not exist
+   * @throws Error if the database is not connected
+   */
+  public static expire(tablename: string, batch_size?: number): number {
+    const table = this.get_table(tablename);
+    return table.expire(batch_size);
+  }
+
+  /**
+   * Search a field of the given table for words, ranking the entries by how well they match
+   * @param tablename The name of the table to search
+   * @param fieldname The name of the field to search
+   * @param query The words to search for, matched without regard to case or accents
+   * @param k The maximum number of entries to return
+   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
+   * @returns The k entries that best match the query, best match first
+   * @throws Error if the table or field does not exist
+   * @throws Error if the database is not connected
+   */
+  public static search<T = TEntry>(tablename: string, fieldname: fieldname, query: string, k?: number): Array<T> {
+    const table = this.get_table(tablename);
+    return table.search<T>(fieldname, query, k);
+  }
+  /**
+   * Keep a hash index of a field of the given table in memory, so get_where and get_unique_where on the field find their entries without a scan
+   * @param tablename The name of the table to index
+   * @param fieldname The name of the field to index
+   * @throws Error if the table or field does not exist
+   * @throws Error if the database is not connected
+   */
+  public static create_hash_index(tablename: string, fieldname: fieldname): void {
+    const table = this.get_table(tablename);
+    table.create_hash_index(fieldname);
+  }
+}
+/**
+ * The operations of the binary protocol between DatabaseClient and DatabaseServer, sent in the op byte of a request
+ */
+const WIRE_OPS = {
+  get: 1,
+  get_many: 2,
+  post: 3,
+  post_many: 4,
+  patch: 5,
+  delete: 6,
+  query: 7,
+  cursor_open: 8,
+  cursor_next: 9,
+  cursor_close: 10,
+  join: 11,
+} as const;
+
+/**
+ * The status sent in the op byte of a response
+ */
+const WIRE_OK = 0;
+const WIRE_ERROR = 1;
+
+/**
+ * The field count written for a missing entry, e.g. the result of getting an id that does not exist
+ */
+const WIRE_NULL_ENTRY = 0xFFFFFFFF;
+
+/**
+ * The largest frame either side sends or accepts, not counting its length, so a corrupted length cannot make the other side buffer without limit
+ */
+const WIRE_MAX_FRAME = 256 * 1024 * 1024;
+
+/**
+ * The Table methods that can be run with the query operation, all taking a field name and a value
+ */
+const WIRE_QUERY_METHODS: ReadonlySet<string> = new Set([
+  "get_all",
+  "get_where", "get_where_not", "get_where_gt", "get_where_lt", "get_where_gte", "get_where_lte",
+  "get_where_contains", "get_where_not_contains", "get_where_starts_with", "get_where_ends_with",
+  "get_unique_where", "get_unique_where_not", "get_unique_where_gt", "get_unique_where_lt", "get_unique_where_gte", "get_unique_where_lte",
+  "get_unique_where_contains", "get_unique_where_not_contains", "get_unique_where_starts_with", "get_unique_where_ends_with",
+]);
+
+/**
+ * Builds a frame of the binary protocol: the length of the rest of the frame, the request id, the op or status byte, then the payload.
+ * The payload of a request starts with its deadline in milliseconds, 0 for none.
+ * Strings are their UTF-8 length then their bytes, entries are their field count then the name and value of every field
+ */
+class WireWriter {
+  private buffer: Buffer = Buffer.allocUnsafe(256);
+  private length: number = 9;
+
+  /**
+   * Make room for the given number of bytes at the end of the frame
+   */
+  private reserve(bytes: number): void {
+    if (this.length + bytes <= this.buffer.length) return;
+    const grown = Buffer.allocUnsafe(Math.max(this.buffer.length * 2, this.length + bytes));
+    this.buffer.copy(grown, 0, 0, this.length);
+    this.buffer = grown;
+  }
+
+  /**
+   * Write an unsigned 32-bit integer
+   */
+  public u32(value: number): this {
+    this.reserve(4);
+    this.buffer.writeUInt32LE(value, this.length);
+    this.length += 4;
+    return this;
+  }
+
+  /**
+   * Write a string
+   */
+  public string(value: string): this {
+    const bytes = Buffer.byteLength(value, 'utf8');
+    this.reserve(4 + bytes);
+    this.buffer.writeUInt32LE(bytes, this.length);
+    this.buffer.write(value, this.length + 4, bytes, 'utf8');
+    this.length += 4 + bytes;
+    return this;
+  }
+
+  /**
+   * Write an entry, or a missing entry for null. The server writes entries as they are stored, so the conversion to strings only applies to the entries a client sends
+   */
+  public entry(entry: Record<string, any> | null): this {
+    if (entry === null) return this.u32(WIRE_NULL_ENTRY);
+    const fieldnames = Object.keys(entry);
+    this.u32(fieldnames.length);
+    for (const fieldname of fieldnames) this.string(fieldname).string(String(entry[fieldname]));
+    return this;
+  }
+
+  /**
+   * Write the number of entries, then every entry
+   */
+  public entries(entries: Array<Record<string, any> | null>): this {
+    this.u32(entries.length);
+    for (const entry of entries) this.entry(entry);
+    return this;
+  }
+
+  /**
+   * Write the header of the frame
+   * @param request_id The id of the request, sent back in its response
+   * @param op The operation of a request, or the status of a response
+   * @returns The frame
+   * @throws Error if the frame is larger than WIRE_MAX_FRAME
+   */
+  public finish(request_id: number, op: number): Buffer {
+    if (this.length - 4 > WIRE_MAX_FRAME) throw new Error(`Frame of ${this.length - 4} bytes is larger than the limit of ${WIRE_MAX_FRAME} bytes`);
+    this.buffer.writeUInt32LE(this.length - 4, 0);
+    this.buffer.writeUInt32LE(request_id, 4);
+    this.buffer.writeUInt8(op, 8);
+    return this.buffer.subarray(0, this.length);
+  }
+}
+
+/**
+ * Reads the payload of a frame of the binary protocol, in the order it was written by a WireWriter
+ */
+class WireReader {
+  private readonly buffer: Buffer;
+  private offset: number;
+  private readonly end: number;
+
+  /**
+   * @param buffer The buffer holding the frame
+   * @param start The position of the payload in the buffer
+   * @param end The position after the end of the frame
+   */
+  constructor(buffer: Buffer, start: number, end: number) {
+    this.buffer = buffer;
+    this.offset = start;
+    this.end = end;
+  }
+
+  /**
+   * Read an unsigned 32-bit integer
+   */
+  public u32(): number {
+    if (this.offset + 4 > this.end) throw new Error("Malformed frame: payload is too short");
+    const value = this.buffer.readUInt32LE(this.offset);
+    this.offset += 4;
+    return value;
+  }
+
+  /**
+   * Read one of the next strings without moving past them, e.g. to look at the tables of a request before running it
+   * @param index The position of the string among the next strings, 0 for the next one
+   */
+  public peek_string(index: number = 0): string {
+    const offset = this.offset;
+    for (let i = 0; i < index; i++) this.string();
+    const value = this.string();
+    this.offset = offset;
+    return value;
+  }
+
+  /**
+   * Read a string
+   */
+  public string(): string {
+    const bytes = this.u32();
+    if (this.offset + bytes > this.end) throw new Error("Malformed frame: payload is too short");
+    const value = this.buffer.toString('utf8', this.offset, this.offset + bytes);
+    this.offset += bytes;
+    return value;
+  }
+
+  /**
+   * Read an entry, null for a missing entry
+   */
+  public entry(): TEntry | null {
+    const field_count = this.u32();
+    if (field_count === WIRE_NULL_ENTRY) return null;
+    const entry: TEntry = {};
+    for (let i = 0; i < field_count; i++) entry[this.string()] = this.string();
+    return entry;
+  }
+
+  /**
+   * Read a list of entries
+   */
+  public entries(): Array<TEntry | null> {
+    const count = this.u32();
+    const entries: Array<TEntry | null> = [];
+    for (let i = 0; i < count; i++) entries.push(this.entry());
+    return entries;
+  }
+}
+
+/**
+ * The classes of requests the server schedules separately: point reads and writes of single entries, scans of tables, and bulk writes
+ */
+type TRequestClass = "point" | "scan" | "bulk";
+
+/**
+ * The class of the requests of every operation. Filter queries and joins scan a table unless the field is indexed, so they are all scheduled as scans
+ */
+const WIRE_OP_CLASSES: Record<number, TRequestClass> = {
+  [WIRE_OPS.get]: "point",
+  [WIRE_OPS.get_many]: "point",
+  [WIRE_OPS.post]: "point",
+  [WIRE_OPS.post_many]: "bulk",
+  [WIRE_OPS.patch]: "point",
+  [WIRE_OPS.delete]: "point",
+  [WIRE_OPS.query]: "scan",
+  [WIRE_OPS.cursor_open]: "scan",
+  [WIRE_OPS.cursor_next]: "point",
+  [WIRE_OPS.cursor_close]: "point",
+  [WIRE_OPS.join]: "scan",
+};
+
+/**
+ * A request waiting in the queue of its class
+ */
+type TQueuedRequest = {
+  readonly connection: TConnection;
+  readonly id: number;
+  readonly op: number;
+  readonly payload: WireReader;
+
+  /**
+   * The time after which the request is answered with an error instead of being run, Infinity if it has no deadline
+   */
+  readonly deadline: number;
+}
+
+/**
+ * The state the server keeps for a connected client
+ */
+type TConnection = {
+  readonly socket: any;
+
+  /**
+   * The results of open cursors, by cursor id, with the timer closing each cursor once it has not been read for a while
+   */
+  readonly cursors: Map<number, { entries: Array<TEntry | null>, position: number, timer: any }>;
+  next_cursor: number;
+
+  /**
+   * The responses to send at the end of the current scheduling turn
+   */
+  responses: Array<Buffer>;
+}
+
+/**
+ * The counters of a request class of a DatabaseServer
+ */
+export type TRequestClassStats = {
+  /**
+   * The number of requests waiting to run
+   */
+  readonly queued: number;
+
+  /**
+   * The number of requests running while the event loop serves other requests, always 0 for point requests
+   */
+  readonly running: number;
+  readonly completed: number;
+
+  /**
+   * The number of requests answered with an error because the queue of their class was full
+   */
+  readonly rejected: number;
+
+  /**
+   * The number of requests answered with an error because their deadline passed before they could run
+   */
+  readonly expired: number;
+
+  /**
+   * The number of times a request was put back in its queue because its table was over its quotas
+   */
+  readonly throttled: number;
+}
+
+/**
+ * Split the frames received on a socket, calling the handler with the request or response id, the op or status byte and a reader of the payload.
+ * The chunks of a frame split across chunks are kept until the rest of it arrives, then copied into one buffer once.
+ * A frame whose length is below the header or above WIRE_MAX_FRAME destroys the socket with an error
+ * @param socket The socket to read frames from
+ * @param handler The function to call for every whole frame, then once after the frames of a chunk with no frame
+ */
+function read_frames(socket: any, handler: (frame: { id: number, op: number, payload: WireReader } | null) => void): void {
+  const chunks: Array<Buffer> = [];
+  let buffered = 0;
+  let failed = false;
+
+  // the length of a frame counts the request id and the op byte
+  const is_valid = (length: number): boolean => {
+    if (length >= 5 && length <= WIRE_MAX_FRAME) return true;
+    failed = true;
+    chunks.length = 0;
+    socket.destroy(new Error(`Malformed frame: length ${length} is not between 5 and ${WIRE_MAX_FRAME} bytes`));
+    return false;
+  };
+
+  socket.on('data', (chunk: Buffer) => {
+    if (failed) return;
+    chunks.push(chunk);
+    buffered += chunk.length;
+    if (buffered < 4) return;
+    const length = (chunks[0].length >= 4 ? chunks[0] : Buffer.concat(chunks, 4)).readUInt32LE(0);
+    if (!is_valid(length) || buffered < 4 + length) return;
+
+    const data = chunks.length === 1 ? chunks[0] : Buffer.concat(chunks, buffered);
+    let offset = 0;
+    while (data.length - offset >= 4) {
+      const frame_length = data.readUInt32LE(offset);
+      if (!is_valid(frame_length)) return;
+      const end = offset + 4 + frame_length;
+      if (end > data.length) break;
+      handler({ id: data.readUInt32LE(offset + 4), op: data.readUInt8(offset + 8), payload: new WireReader(data, offset + 9, end) });
+      offset = end;
+    }
+    chunks.length = 0;
+    buffered = data.length - offset;
+    if (buffered) chunks.push(data.subarray(offset));
+    handler(null);
+  });
+}
+
+/**
+ * Serves the tables of the connected database to DatabaseClient instances over a Unix socket (a named pipe on Windows), with the binary protocol.
+ * Requests are queued by class (point, scan or bulk write), and the scheduler runs them with smooth weighted round-robin,
+ * so point requests keep running between the scans and bulk writes queued before them. Point requests run to completion in their turn,
+ * while scans and bulk writes read their entry files without blocking the event loop, a few of them at a time. A full queue rejects new requests of its class,
+ * and a request whose deadline passes while it is queued is answered with an error without being run.
+ * Requests to a table over its I/O or CPU quota stay queued until the table is within its quotas again, while the requests to other tables run.
+ * The answers to the requests run in one scheduling turn are sent in one write per client
+ *
+ * @example
+ * Database.connect("./database/");
+ * const server = new DatabaseServer();
+ * await server.listen("/tmp/database.sock");
+ */
+export class DatabaseServer {
+  /**
+   * The listening server, null until DatabaseServer.listen() is called
+   */
+  private server: any = null;
+
+  /**
+   * The number of entries sent at most in a response to the cursor_next operation
+   */
+  private static readonly max_cursor_batch: number = 10_000;
+
+  /**
+   * The number of cursors a client can have open at once, and how long a cursor stays open without being read.
+   * An open cursor holds its whole result in the server's memory
+   */
+  private static readonly max_cursors: number = 16;
+  private static readonly cursor_idle_ms: number = 60_000;
+
+  /**
+   * How many requests of each class run for each other when every queue has requests, and how many requests of each class can wait
+   */
+  private static readonly class_weights: Record<TRequestClass, number> = { point: 8, scan: 2, bulk: 1 };
+  private static readonly class_queue_limits: Record<TRequestClass, number> = { point: 100_000, scan: 64, bulk: 16 };
+
+  /**
+   * How many requests of each class can run at once. Scans and bulk writes keep running while the event loop serves other requests
+   */
+  private static readonly class_concurrency: Record<TRequestClass, number> = { point: Infinity, scan: 4, bulk: 1 };
+
+  /**
+   * How long a scheduling turn runs requests before the event loop is given the chance to read new requests
+   */
+  private static readonly turn_ms: number = 5;
+
+  /**
+   * The queued requests of each class, in the order they arrived
+   */
+  private readonly queues: Record<TRequestClass, Array<TQueuedRequest>> = { point: [], scan: [], bulk: [] };
+
+  /**
+   * The current weight of each class in the smooth weighted round-robin
+   */
+  private readonly current_weights: Record<TRequestClass, number> = { point: 0, scan: 0, bulk: 0 };
+
+  /**
+   * The number of scans and bulk writes of each class that have started and not finished yet
+   */
+  private readonly running: Record<TRequestClass, number> = { point: 0, scan: 0, bulk: 0 };
+
+  private readonly stats: Record<TRequestClass, { completed: number, rejected: number, expired: number, throttled: number }> = {
+    point: { completed: 0, rejected: 0, expired: 0, throttled: 0 },
+    scan: { completed: 0, rejected: 0, expired: 0, throttled: 0 },
+    bulk: { completed: 0, rejected: 0, expired: 0, throttled: 0 },
+  };
+
+  /**
+   * Whether a scheduling turn is planned
+   */
+  private scheduled: boolean = false;
+
+  /**
+   * The timer planning a turn once the throttled tables are within their quotas again, when only requests to throttled tables are queued
+   */
+  private throttle_timer: any = null;
+
+  /**
+   * The connections with responses to send at the end of the current scheduling turn
+   */
+  private readonly answered: Set<TConnection> = new Set();
+
+  /**
+   * Start accepting clients
+   * @param path The path to the Unix socket to create, or the name of the named pipe on Windows
+   */
+  public listen(path: string): Promise<void> {
+    if (process.platform !== "win32" && fs.existsSync(path)) fs.unlinkSync(path);
+    this.server = net.createServer((socket: any) => this.serve(socket));
+    return new Promise((resolve, reject) => {
+      this.server.once('error', reject);
+      this.server.listen(path, () => resolve());
+    });
   }
 
   /**
-   * Get all entries from the given table where the given field is greater than the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field is greater than the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Stop accepting clients, and close the connections of connected clients
    */
-  public static get_where_gt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_gt<T>(fieldname, value);
+  public close(): Promise<void> {
+    return new Promise((resolve) => {
+      if (!this.server) return resolve();
+      this.server.close(() => resolve());
+      this.server = null;
+    });
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is greater than the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field is greater than the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Answer the requests of a client until it disconnects
+   * @param socket The client's socket, or the RingSocket of a DatabaseWorker
    */
-  public static get_unique_where_gt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_gt<T>(fieldname, value);
+  public serve(socket: any): void {
+    const connection: TConnection = { socket, cursors: new Map(), next_cursor: 1, responses: [] };
+
+    read_frames(socket, (frame) => {
+      if (!frame) return this.schedule();
+
+      const request_class = WIRE_OP_CLASSES[frame.op] ?? "point";
+      if (this.queues[request_class].length >= DatabaseServer.class_queue_limits[request_class]) {
+        this.stats[request_class].rejected++;
+        connection.responses.push(new WireWriter().string(`Server is overloaded: too many ${request_class} requests are queued`).finish(frame.id, WIRE_ERROR));
+        this.answered.add(connection);
+        return;
+      }
+
+      // the deadline is relative, so the clocks of the client and the server do not need to agree
+      const deadline_ms = frame.payload.u32();
+      const deadline = deadline_ms === 0 ? Infinity : Date.now() + deadline_ms;
+      this.queues[request_class].push({ connection, id: frame.id, op: frame.op, payload: frame.payload, deadline });
+    });
+    socket.on('error', () => socket.destroy());
+    socket.on('close', () => {
+      for (const id of [...connection.cursors.keys()]) DatabaseServer.close_cursor(connection, id);
+    });
   }
 
   /**
-   * Get all entries from the given table where the given field is less than the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field is less than the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Close a cursor of a client, dropping its result
    */
-  public static get_where_lt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_lt<T>(fieldname, value);
+  private static close_cursor(connection: TConnection, id: number): void {
+    clearTimeout(connection.cursors.get(id)?.timer);
+    connection.cursors.delete(id);
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is less than the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field is less than the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Get the counters of every request class
    */
-  public static get_unique_where_lt<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_lt<T>(fieldname, value);
+  public get_stats(): Record<TRequestClass, TRequestClassStats> {
+    const stats = {} as Record<TRequestClass, TRequestClassStats>;
+    for (const request_class of Object.keys(this.queues) as Array<TRequestClass>) {
+      stats[request_class] = { queued: this.queues[request_class].length, running: this.running[request_class], ...this.stats[request_class] };
+    }
+    return stats;
   }
 
   /**
-   * Get all entries from the given table where the given field is greater than or equal to the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field is greater than or equal to the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Plan a scheduling turn once the event loop has read the requests that already arrived
    */
-  public static get_where_gte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_gte<T>(fieldname, value);
+  private schedule(): void {
+    if (this.scheduled) return;
+    this.scheduled = true;
+    setImmediate(() => this.run_turn());
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is greater than or equal to the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field is greater than or equal to the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Check whether a class has queued requests and can start another one
    */
-  public static get_unique_where_gte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_gte<T>(fieldname, value);
+  private is_runnable(request_class: TRequestClass): boolean {
+    return this.queues[request_class].length > 0 && this.running[request_class] < DatabaseServer.class_concurrency[request_class];
   }
 
   /**
-   * Get all entries from the given table where the given field is less than or equal to the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field is less than or equal to the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Pick the class of the next request to run with smooth weighted round-robin: every class that can start a queued request gains its weight,
+   * the class with the highest current weight runs and loses the total weight of the classes that could run
+   * @returns The class, or null if no class can start a request
    */
-  public static get_where_lte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_lte<T>(fieldname, value);
+  private next_class(): TRequestClass | null {
+    let picked: TRequestClass | null = null;
+    let total = 0;
+    for (const request_class of Object.keys(this.queues) as Array<TRequestClass>) {
+      if (!this.is_runnable(request_class)) continue;
+      this.current_weights[request_class] += DatabaseServer.class_weights[request_class];
+      total += DatabaseServer.class_weights[request_class];
+      if (picked === null || this.current_weights[request_class] > this.current_weights[picked]) picked = request_class;
+    }
+    if (picked !== null) this.current_weights[picked] -= total;
+    return picked;
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field is less than or equal to the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field is less than or equal to the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Run queued requests for up to DatabaseServer.turn_ms, then send their responses and plan the next turn if requests are left.
+   * Scans and bulk writes are only started in the turn, and their responses are sent at the end of the turn after they finish
    */
-  public static get_unique_where_lte<T = TEntry>(tablename: string, fieldname: fieldname, value: number): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_lte<T>(fieldname, value);
+  private run_turn(): void {
+    this.scheduled = false;
+    const end = Date.now() + DatabaseServer.turn_ms;
+
+    // requests to tables over their quotas are put back at the front of their queue after the turn, instead of blocking the event loop while the table waits
+    const throttled: Record<TRequestClass, Array<TQueuedRequest>> = { point: [], scan: [], bulk: [] };
+    let throttle_delay = Infinity;
+
+    for (let request_class = this.next_class(); request_class !== null; request_class = this.next_class()) {
+      const request = this.queues[request_class].shift()!;
+      const { connection } = request;
+
+      const delay = Date.now() > request.deadline ? 0 : this.get_throttle_delay(request);
+      if (delay > 0) {
+        this.stats[request_class].throttled++;
+        throttled[request_class].push(request);
+        throttle_delay = Math.min(throttle_delay, delay);
+        continue;
+      }
+
+      if (Date.now() > request.deadline) {
+        this.stats[request_class].expired++;
+        connection.responses.push(new WireWriter().string("Deadline exceeded before the request could run").finish(request.id, WIRE_ERROR));
+        this.answered.add(connection);
+      } else if (request_class !== "point") {
+        this.run_async(request, request_class);
+      } else {
+        this.answered.add(connection);
+        const response = new WireWriter();
+        try {
+          this.handle(request.op, request.payload, response, connection);
+          connection.responses.push(response.finish(request.id, WIRE_OK));
+        } catch (err: any) {
+          connection.responses.push(new WireWriter().string(err.message).finish(request.id, WIRE_ERROR));
+        }
+        this.stats[request_class].completed++;
+      }
+
+      if (Date.now() >= end) break;
+    }
+
+    for (const connection of this.answered) {
+      if (connection.responses.length) connection.socket.write(connection.responses.length === 1 ? connection.responses[0] : Buffer.concat(connection.responses));
+      connection.responses = [];
+    }
+    this.answered.clear();
+
+    // a class at its concurrency limit is run again when one of its requests finishes
+    const runnable = (Object.keys(this.queues) as Array<TRequestClass>).some((request_class: TRequestClass) => this.is_runnable(request_class));
+    for (const request_class of Object.keys(throttled) as Array<TRequestClass>) this.queues[request_class].unshift(...throttled[request_class]);
+    if (runnable) this.schedule();
+    else if (throttle_delay !== Infinity && !this.throttle_timer) {
+      this.throttle_timer = setTimeout(() => {
+        this.throttle_timer = null;
+        this.schedule();
+      }, throttle_delay);
+    }
   }
 
   /**
-   * Get all entries from the given table where the given field contains the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field contains the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Run a scan or bulk write without blocking the event loop, then send its response at the end of the next turn
    */
-  public static get_where_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_contains<T>(fieldname, value);
+  private async run_async(request: TQueuedRequest, request_class: TRequestClass): Promise<void> {
+    const { connection } = request;
+    this.running[request_class]++;
+    const response = new WireWriter();
+    try {
+      await this.handle_async(request.op, request.payload, response, connection);
+      connection.responses.push(response.finish(request.id, WIRE_OK));
+    } catch (err: any) {
+      connection.responses.push(new WireWriter().string(err.message).finish(request.id, WIRE_ERROR));
+    }
+    this.running[request_class]--;
+    this.stats[request_class].completed++;
+    this.answered.add(connection);
+    this.schedule();
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field contains the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field contains the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Get how long the table of a request has to wait for its quotas, the longer wait of its two tables for a join. Cursor batches are sent from memory and never wait.
+   * Point writes also wait while writes are frozen, as on the event loop they would fail instead of waiting for the freeze to be lifted
+   * @returns The delay in milliseconds, 0 if the request can run now
    */
-  public static get_unique_where_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_contains<T>(fieldname, value);
+  private get_throttle_delay(request: TQueuedRequest): number {
+    if (request.op === WIRE_OPS.cursor_next || request.op === WIRE_OPS.cursor_close) return 0;
+    if ((request.op === WIRE_OPS.post || request.op === WIRE_OPS.patch || request.op === WIRE_OPS.delete) && WriteFreeze.is_frozen()) return 5;
+    try {
+      const delay = Database.get_table(request.payload.peek_string()).get_throttle_delay();
+      // a join's payload is the left table, the left field, then the right table
+      if (request.op !== WIRE_OPS.join) return delay;
+      return Math.max(delay, Database.get_table(request.payload.peek_string(2)).get_throttle_delay());
+    } catch (err: any) {
+      // the request fails with the same error when it runs
+      return 0;
+    }
   }
 
   /**
-   * Get all entries from the given table where the given field does not contain the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field does not contain the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Run a point request and write its result to the response
+   * @throws Error if the request fails, sent to the client as the error of the request
    */
-  public static get_where_not_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_not_contains<T>(fieldname, value);
+  private handle(op: number, payload: WireReader, response: WireWriter, connection: TConnection): void {
+    switch (op) {
+      case WIRE_OPS.get: {
+        const table = Database.get_table(payload.string());
+        response.entry(table.get_unparsed(payload.u32()));
+        return;
+      }
+      case WIRE_OPS.get_many: {
+        const table = Database.get_table(payload.string());
+        const count = payload.u32();
+        const entries: Array<TEntry | null> = [];
+        for (let i = 0; i < count; i++) entries.push(table.get_unparsed(payload.u32()));
+        response.entries(entries);
+        return;
+      }
+      case WIRE_OPS.post: {
+        const table = Database.get_table(payload.string());
+        response.entry(table.post_unparsed(payload.entry()!));
+        return;
+      }
+      case WIRE_OPS.patch: {
+        const table = Database.get_table(payload.string());
+        const id = payload.u32();
+        response.entry(table.patch_unparsed(id, payload.entry()!));
+        return;
+      }
+      case WIRE_OPS.delete: {
+        const table = Database.get_table(payload.string());
+        response.entry(table.delete_unparsed(payload.u32()));
+        return;
+      }
+      case WIRE_OPS.cursor_next: {
+        const id = payload.u32();
+        const cursor = connection.cursors.get(id);
+        if (!cursor) throw new Error(`Cursor ${id} does not exist, or was closed after ${DatabaseServer.cursor_idle_ms / 1000} seconds without being read`);
+        const count = Math.min(payload.u32(), DatabaseServer.max_cursor_batch);
+        const batch = cursor.entries.slice(cursor.position, cursor.position + count);
+        response.entries(batch);
+        cursor.position += batch.length;
+        if (batch.length === 0) DatabaseServer.close_cursor(connection, id);
+        else cursor.timer.refresh();
+        return;
+      }
+      case WIRE_OPS.cursor_close: {
+        DatabaseServer.close_cursor(connection, payload.u32());
+        return;
+      }
+      default:
+        throw new Error(`Unknown operation ${op}`);
+    }
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field does not contain the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field does not contain the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Run a scan or bulk write and write its result to the response, reading the entry files without blocking the event loop.
+   * The payload is read before the first file is, as the frame holding it is not kept once the request has started
+   * @throws Error if the request fails, sent to the client as the error of the request
    */
-  public static get_unique_where_not_contains<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_not_contains<T>(fieldname, value);
+  private async handle_async(op: number, payload: WireReader, response: WireWriter, connection: TConnection): Promise<void> {
+    switch (op) {
+      case WIRE_OPS.post_many: {
+        const table = Database.get_table(payload.string());
+        response.entries(await table.post_many_unparsed_async(payload.entries() as Array<TEntry>));
+        return;
+      }
+      case WIRE_OPS.query: {
+        response.entries(await this.query(payload));
+        return;
+      }
+      case WIRE_OPS.cursor_open: {
+        const entries = await this.query(payload);
+        // checked once the query has run, as the client's other cursors may have been opened meanwhile
+        if (connection.cursors.size >= DatabaseServer.max_cursors) {
+          throw new Error(`Too many open cursors: a client can have ${DatabaseServer.max_cursors} cursors open, close one before opening another`);
+        }
+        const id = connection.next_cursor++;
+        const timer = setTimeout(() => connection.cursors.delete(id), DatabaseServer.cursor_idle_ms);
+        // an open cursor does not keep the process alive
+        timer.unref();
+        connection.cursors.set(id, { entries, position: 0, timer });
+        response.u32(id);
+        return;
+      }
+      case WIRE_OPS.join: {
+        const table = Database.get_table(payload.string());
+        const fieldname = payload.string();
+        const right = Database.get_table(payload.string());
+        // the rows are sent as their left and right entries one after the other
+        const rows = await table.join_unparsed_async(fieldname, right, payload.string());
+        response.entries(rows.flatMap((row: TJoinedRow) => [row.left, row.right]));
+        return;
+      }
+      default:
+        throw new Error(`Unknown operation ${op}`);
+    }
   }
 
   /**
-   * Get all entries from the given table where the given field starts with the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field starts with the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Run the query of a query or cursor_open request: the table, the name of the Table method, the field name and the value.
+   * The entries are sent as they are stored, without the table's parseFunction
+   * @returns The entries returned by the method, a unique query returning at most one entry
    */
-  public static get_where_starts_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_starts_with<T>(fieldname, value);
+  private async query(payload: WireReader): Promise<Array<TEntry>> {
+    const table = Database.get_table(payload.string());
+    const method = payload.string();
+    const fieldname = payload.string();
+    const value = payload.string();
+    if (!WIRE_QUERY_METHODS.has(method)) throw new Error(`Unknown query method '${method}'`);
+    return table.query_unparsed_async(method, fieldname, value);
   }
+}
 
+/**
+ * A connection to a DatabaseServer. Requests can be sent without waiting for the previous ones to be answered:
+ * every request has an id that its response carries, and the requests made in the same tick are sent in one write.
+ * Entries are returned as they are stored, every field a string, as the server does not run the parseFunction of its tables:
+ * the client parses them with its own
+ *
+ * @example
+ * const client = await DatabaseClient.connect("/tmp/database.sock");
+ * const [user, orders] = await Promise.all([client.get("Users", 1), client.query("Orders", "get_where", "user", "1")]);
+ */
+export class DatabaseClient {
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field starts with the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field starts with the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * The socket connected to the server
    */
-  public static get_unique_where_starts_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_starts_with<T>(fieldname, value);
+  private readonly socket: any;
+
+  /**
+   * The requests waiting for a response, by request id
+   */
+  private readonly pending: Map<number, { resolve: (payload: WireReader) => void, reject: (error: Error) => void }> = new Map();
+
+  /**
+   * The requests made since the last write, sent together once the current tick ends
+   */
+  private outgoing: Array<Buffer> = [];
+
+  /**
+   * The id of the next request, wrapping around before it no longer fits in the frame header
+   */
+  private next_request_id: number = 1;
+
+  /**
+   * How long the server may keep a request queued before answering it with an error instead of running it, in milliseconds, 0 for no deadline.
+   * Applies to the requests made after it is set
+   */
+  public deadline_ms: number = 0;
+
+  /**
+   * @important This constructor is not meant to be used directly, clients are created by DatabaseClient.connect() and DatabaseWorker.start()
+   * @param socket The socket connected to the server
+   */
+  constructor(socket: any) {
+    this.socket = socket;
+    read_frames(socket, (frame) => {
+      if (!frame) return;
+      const request = this.pending.get(frame.id);
+      if (!request) return;
+      this.pending.delete(frame.id);
+      if (frame.op === WIRE_OK) request.resolve(frame.payload);
+      else request.reject(new Error(frame.payload.string()));
+    });
+
+    const fail = (error: Error) => {
+      for (const request of this.pending.values()) request.reject(error);
+      this.pending.clear();
+    };
+    socket.on('error', fail);
+    socket.on('close', () => fail(new Error("Connection to the database server closed")));
   }
 
   /**
-   * Get all entries from the given table where the given field ends with the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns All entries from the given table where the given field ends with the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Connect to a server
+   * @param path The path to the server's Unix socket, or the name of its named pipe on Windows
    */
-  public static get_where_ends_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): Array<T> {
-    const table = this.get_table(tablename);
-    return table.get_where_ends_with<T>(fieldname, value);
+  public static connect(path: string): Promise<DatabaseClient> {
+    return new Promise((resolve, reject) => {
+      const socket = net.createConnection(path);
+      socket.once('error', reject);
+      socket.once('connect', () => {
+        socket.removeListener('error', reject);
+        resolve(new DatabaseClient(socket));
+      });
+    });
   }
 
   /**
-   * Assuming there is only one entry that matches the search, get the entry from the given table where the given field ends with the given value
-   * @param tablename The name of the table to get the entry from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @generic <T> the type of the entry - must be the same as what is returned by the parseFunction - defaults to TEntry
-   * @returns The sole entry from the given table where the given field ends with the given value
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
-   * @throws Error if there is not exactly one entry that passes the given filter
+   * Close the connection, failing the requests still waiting for a response
    */
-  public static get_unique_where_ends_with<T = TEntry>(tablename: string, fieldname: fieldname, value: string): T | null {
-    const table = this.get_table(tablename);
-    return table.get_unique_where_ends_with<T>(fieldname, value);
+  public close(): void {
+    this.socket.end();
+  }
+
+  /**
+   * Send a request, queued until the end of the tick so the requests made together are sent in one write
+   * @param op The operation
+   * @param write_payload The function writing the payload of the request
+   * @returns A reader of the payload of the response
+   * @throws Error if the request is larger than WIRE_MAX_FRAME
+   */
+  private request(op: number, write_payload: (writer: WireWriter) => void): Promise<WireReader> {
+    const id = this.next_request_id;
+    this.next_request_id = this.next_request_id === 0xFFFFFFFF ? 1 : this.next_request_id + 1;
+    const writer = new WireWriter().u32(this.deadline_ms);
+    write_payload(writer);
+    const frame = writer.finish(id, op);
+
+    if (this.outgoing.length === 0) {
+      process.nextTick(() => {
+        this.socket.write(this.outgoing.length === 1 ? this.outgoing[0] : Buffer.concat(this.outgoing));
+        this.outgoing = [];
+      });
+    }
+    this.outgoing.push(frame);
+    return new Promise((resolve, reject) => this.pending.set(id, { resolve, reject }));
+  }
+
+  /**
+   * Get an entry of a table
+   * @returns The entry with the given id if it exists, otherwise null
+   */
+  public async get(tablename: string, id: entryid): Promise<TEntry | null> {
+    return (await this.request(WIRE_OPS.get, (w: WireWriter) => w.string(tablename).u32(id))).entry();
+  }
+
+  /**
+   * Get several entries of a table in one request
+   * @returns The entries in the order of the ids, null for the ids that do not exist
+   */
+  public async get_many(tablename: string, ids: Array<entryid>): Promise<Array<TEntry | null>> {
+    return (await this.request(WIRE_OPS.get_many, (w: WireWriter) => {
+      w.string(tablename).u32(ids.length);
+      for (const id of ids) w.u32(id);
+    })).entries();
+  }
+
+  /**
+   * Create a new entry in a table
+   * @returns The created entry
+   */
+  public async post(tablename: string, data: TEntry): Promise<TEntry> {
+    return (await this.request(WIRE_OPS.post, (w: WireWriter) => w.string(tablename).entry(data))).entry()!;
+  }
+
+  /**
+   * Create several entries in a table in one request
+   * @returns The created entries, in the given order
+   */
+  public async post_many(tablename: string, entries: Array<TEntry>): Promise<Array<TEntry>> {
+    return (await this.request(WIRE_OPS.post_many, (w: WireWriter) => w.string(tablename).entries(entries))).entries() as Array<TEntry>;
+  }
+
+  /**
+   * Update some fields of an entry of a table
+   * @returns The updated entry
+   */
+  public async patch(tablename: string, id: entryid, updated_fields: TEntry): Promise<TEntry> {
+    return (await this.request(WIRE_OPS.patch, (w: WireWriter) => w.string(tablename).u32(id).entry(updated_fields))).entry()!;
   }
 
-  /// *** FILTER-QUERY PATCH METHODS *** ///
-
   /**
-   * Update all entries from the given table
-   * @param tablename The name of the table to update the entries in
-   * @param updated_fields The fields to update
-   * @warning be careful using this method
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Delete an entry of a table
+   * @returns The deleted entry
    */
-  public static patch_all(tablename: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_all(updated_fields);
+  public async delete(tablename: string, id: entryid): Promise<TEntry> {
+    return (await this.request(WIRE_OPS.delete, (w: WireWriter) => w.string(tablename).u32(id))).entry()!;
   }
 
   /**
-   * Update all entries from the given table that pass the filter
-   * @param tablename The name of the table to update the entries in
-   * @param filter The filter to apply to the entries
-   * @param updated_fields The updated fields to apply to the entries
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Run a filter query on the server
+   * @param method The name of the Table method to run: get_all, or a get_where or get_unique_where method
+   * @param fieldname The name of the field to compare, ignored by get_all
+   * @param value The value to compare the field with, sent as a string
+   * @returns The entries returned by the method, at most one for a get_unique_where method
    */
-  public static patch_with_filter(tablename: string, filter: TEntriesFilter, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_with_filter(filter, updated_fields);
+  public async query(tablename: string, method: string, fieldname: fieldname = "", value: string | number = ""): Promise<Array<TEntry>> {
+    return (await this.request(WIRE_OPS.query, (w: WireWriter) => w.string(tablename).string(method).string(fieldname).string(String(value)))).entries() as Array<TEntry>;
   }
 
   /**
-   * Update all entries from the given table where the given field is equal to the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Join the entries of a table to the entries of another table on the server, see Table.join()
+   * @param fieldname The field of the left table's entries holding the value to join on, "id" for the entry id
+   * @param right_fieldname The field of the right table's entries that must equal the value, the entry id by default
+   * @returns A row for every pair of entries whose fields are equal
    */
-  public static patch_where(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where(fieldname, value, updated_fields);
+  public async join(tablename: string, fieldname: fieldname, right_tablename: string, right_fieldname: fieldname = "id"): Promise<Array<TJoinedRow>> {
+    const entries = (await this.request(WIRE_OPS.join, (w: WireWriter) => w.string(tablename).string(fieldname).string(right_tablename).string(right_fieldname))).entries() as Array<TEntry>;
+    const rows: Array<TJoinedRow> = [];
+    for (let i = 0; i < entries.length; i += 2) rows.push({ left: entries[i], right: entries[i + 1] });
+    return rows;
   }
 
   /**
-   * Update all entries from the given table where the given field is not equal to the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Run a filter query on the server and keep its result there, to read it in batches with DatabaseClient.next()
+   * @returns The id of the cursor
    */
-  public static patch_where_not(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_not(fieldname, value, updated_fields);
+  public async open_cursor(tablename: string, method: string, fieldname: fieldname = "", value: string | number = ""): Promise<number> {
+    return (await this.request(WIRE_OPS.cursor_open, (w: WireWriter) => w.string(tablename).string(method).string(fieldname).string(String(value)))).u32();
   }
 
   /**
-   * Update all entries from the given table where the given field is greater than the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Read the next entries of a cursor. The cursor is closed once a read returns no entries
+   * @param count The maximum number of entries to read
+   * @returns The entries, an empty array once every entry has been read
    */
-  public static patch_where_gt(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_gt(fieldname, value, updated_fields);
+  public async next(cursor: number, count: number): Promise<Array<TEntry>> {
+    return (await this.request(WIRE_OPS.cursor_next, (w: WireWriter) => w.u32(cursor).u32(count))).entries() as Array<TEntry>;
   }
 
   /**
-   * Update all entries from the given table where the given field is less than the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Close a cursor before every entry has been read
    */
-  public static patch_where_lt(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_lt(fieldname, value, updated_fields);
+  public async close_cursor(cursor: number): Promise<void> {
+    await this.request(WIRE_OPS.cursor_close, (w: WireWriter) => w.u32(cursor));
   }
+}
+/**
+ * A byte stream from one thread to another through a ring buffer in a SharedArrayBuffer.
+ * The header holds the number of bytes written, the number of bytes read, whether the writer closed the stream, and a counter of the writer's signals,
+ * as Int32 counters that wrap around. A side waiting for the other sleeps in Atomics.wait or Atomics.waitAsync and is woken by Atomics.notify, a futex wake on Linux
+ */
+class SharedRing {
+  /**
+   * The positions of the counters in the header
+   */
+  private static readonly WRITTEN = 0;
+  private static readonly READ = 1;
+  private static readonly CLOSED = 2;
+  private static readonly SIGNALS = 3;
+  private static readonly header_bytes = 16;
 
   /**
-   * Update all entries from the given table where the given field is greater than or equal to the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * The shared buffer, sent to the other thread to open the same ring
    */
-  public static patch_where_gte(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_gte(fieldname, value, updated_fields);
-  }
+  public readonly buffer: SharedArrayBuffer;
+  private readonly header: Int32Array;
+  private readonly data: Buffer;
 
   /**
-   * Update all entries from the given table where the given field is less than or equal to the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * @param buffer The shared buffer of the ring, created by SharedRing.create() in either thread
    */
-  public static patch_where_lte(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_lte(fieldname, value, updated_fields);
+  constructor(buffer: SharedArrayBuffer) {
+    this.buffer = buffer;
+    this.header = new Int32Array(buffer, 0, 4);
+    this.data = Buffer.from(buffer, SharedRing.header_bytes);
   }
 
   /**
-   * Update all entries from the given table where the given field contains the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Create a ring
+   * @param capacity The number of bytes the ring holds, rounded up to a power of two so the counters stay valid when they wrap around
    */
-  public static patch_where_contains(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_contains(fieldname, value, updated_fields);
+  public static create(capacity: number): SharedRing {
+    return new SharedRing(new SharedArrayBuffer(SharedRing.header_bytes + 2 ** Math.ceil(Math.log2(capacity))));
   }
 
   /**
-   * Update all entries from the given table where the given field does not contain the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * The number of bytes written and not yet read
    */
-  public static patch_where_not_contains(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_not_contains(fieldname, value, updated_fields);
+  private get used(): number {
+    return (Atomics.load(this.header, SharedRing.WRITTEN) - Atomics.load(this.header, SharedRing.READ)) >>> 0;
   }
 
   /**
-   * Update all entries from the given table where the given field starts with the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Whether the writer closed the stream
    */
-  public static patch_where_starts_with(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_starts_with(fieldname, value, updated_fields);
+  public get closed(): boolean {
+    return Atomics.load(this.header, SharedRing.CLOSED) === 1;
   }
 
   /**
-   * Update all entries from the given table where the given field ends with the given value
-   * @param tablename The name of the table to update the entries in
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @param updated_fields The fields to update
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Copy as much of the data into the ring as fits
+   * @returns The number of bytes written
    */
-  public static patch_where_ends_with(tablename: string, fieldname: fieldname, value: string, updated_fields: TEntry): void {
-    const table = this.get_table(tablename);
-    table.patch_where_ends_with(fieldname, value, updated_fields);
+  private write_some(data: Buffer): number {
+    const written = Atomics.load(this.header, SharedRing.WRITTEN);
+    const length = Math.min(data.length, this.data.length - this.used);
+    const start = (written >>> 0) & (this.data.length - 1);
+    const first = Math.min(length, this.data.length - start);
+    data.copy(this.data, start, 0, first);
+    data.copy(this.data, 0, first, length);
+    Atomics.store(this.header, SharedRing.WRITTEN, (written + length) | 0);
+    this.signal();
+    return length;
   }
 
-  /// *** FILTER-QUERY DELETE METHODS *** ///
+  /**
+   * Write data, blocking the thread while the ring is full. Only used by worker threads, which are allowed to block
+   */
+  public write(data: Buffer): void {
+    for (let offset = 0; offset < data.length;) {
+      const read = Atomics.load(this.header, SharedRing.READ);
+      const length = this.write_some(data.subarray(offset));
+      offset += length;
+      if (length === 0) Atomics.wait(this.header, SharedRing.READ, read);
+    }
+  }
 
   /**
-   * Delete all entries from the given table
-   * @param tablename The name of the table to delete the entries from
-   * @warning be careful using this method 
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Write data, waiting without blocking the thread while the ring is full
    */
-  public static delete_all(tablename: string): void {
-    const table = this.get_table(tablename);
-    table.delete_all();
+  public async write_async(data: Buffer): Promise<void> {
+    for (let offset = 0; offset < data.length;) {
+      const read = Atomics.load(this.header, SharedRing.READ);
+      const length = this.write_some(data.subarray(offset));
+      offset += length;
+      if (length === 0) await (Atomics as any).waitAsync(this.header, SharedRing.READ, read).value;
+    }
   }
 
   /**
-   * Delete all entries from the given table that pass the given filter
-   * @param tablename The name of the table to delete the entries from
-   * @param filter The filter to apply to the table
+   * Take the bytes written since the last read
+   * @returns A copy of the bytes, empty if nothing was written
    */
-  public static delete_with_filter(tablename: string, filter: TEntriesFilter): void {
-    const table = this.get_table(tablename);
-    table.delete_with_filter(filter);
+  public read(): Buffer {
+    const read = Atomics.load(this.header, SharedRing.READ);
+    const length = this.used;
+    const start = (read >>> 0) & (this.data.length - 1);
+    const first = Math.min(length, this.data.length - start);
+    const result = Buffer.concat([this.data.subarray(start, start + first), this.data.subarray(0, length - first)]);
+    Atomics.store(this.header, SharedRing.READ, (read + length) | 0);
+    Atomics.notify(this.header, SharedRing.READ);
+    return result;
   }
 
   /**
-   * Delete all entries from the given table where the given field is equal to the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Wake the reader after writing or closing. The reader waits for the signal counter to change,
+   * so a signal sent between its check for new bytes and its wait is not missed
    */
-  public static delete_where(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where(fieldname, value);
+  private signal(): void {
+    Atomics.add(this.header, SharedRing.SIGNALS, 1);
+    Atomics.notify(this.header, SharedRing.SIGNALS);
   }
 
   /**
-   * Delete all entries from the given table where the given field is not equal to the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Wait without blocking the thread until bytes are written or the ring is closed
    */
-  public static delete_where_not(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_not(fieldname, value);
+  public async wait_async(): Promise<void> {
+    const signals = Atomics.load(this.header, SharedRing.SIGNALS);
+    if (this.used === 0 && !this.closed) await (Atomics as any).waitAsync(this.header, SharedRing.SIGNALS, signals).value;
   }
 
   /**
-   * Delete all entries from the given table where the given field is greater than the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Tell the reader no more bytes will be written
    */
-  public static delete_where_gt(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_gt(fieldname, value);
+  public close(): void {
+    Atomics.store(this.header, SharedRing.CLOSED, 1);
+    this.signal();
   }
+}
+
+/**
+ * The end of a pair of shared rings that DatabaseServer and DatabaseClient use in place of a socket:
+ * bytes written go into the outgoing ring and bytes read from the incoming ring are emitted as 'data' events
+ */
+class RingSocket extends EventEmitter {
+  private readonly incoming: SharedRing;
+  private readonly outgoing: SharedRing;
 
   /**
-   * Delete all entries from the given table where the given field is greater than or equal to the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Whether writes block the thread, which only worker threads may do
    */
-  public static delete_where_gte(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_gte(fieldname, value);
+  private readonly blocking: boolean;
+
+  /**
+   * The writes waiting for room in the outgoing ring, in order
+   */
+  private writing: Promise<void> = Promise.resolve();
+
+  /**
+   * @param incoming The ring the other thread writes to
+   * @param outgoing The ring the other thread reads from
+   * @param blocking Whether writes block the thread
+   */
+  constructor(incoming: SharedRing, outgoing: SharedRing, blocking: boolean) {
+    super();
+    this.incoming = incoming;
+    this.outgoing = outgoing;
+    this.blocking = blocking;
   }
 
   /**
-   * Delete all entries from the given table where the given field is less than the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Write data to the outgoing ring, after the data of earlier writes
    */
-  public static delete_where_lt(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_lt(fieldname, value);
+  public write(data: Buffer): void {
+    if (this.blocking) this.outgoing.write(data);
+    else this.writing = this.writing.then(() => this.outgoing.write_async(data));
   }
 
   /**
-   * Delete all entries from the given table where the given field is less than or equal to the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Close the outgoing ring once the earlier writes are done
    */
-  public static delete_where_lte(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_lte(fieldname, value);
+  public end(): void {
+    this.writing = this.writing.then(() => this.outgoing.close());
   }
 
   /**
-   * Delete all entries from the given table where the given field contains the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Close the outgoing ring, called by DatabaseServer when the client errors and by both sides when a frame is malformed
+   * @param error The error to emit, if any
    */
-  public static delete_where_contains(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_contains(fieldname, value);
+  public destroy(error?: Error): void {
+    this.end();
+    if (error) this.emit('error', error);
   }
 
   /**
-   * Delete all entries from the given table where the given field does not contain the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Emit the bytes written to the incoming ring until the ring is closed, letting the event loop run while waiting
    */
-  public static delete_where_not_contains(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_not_contains(fieldname, value);
+  public async pump_async(): Promise<void> {
+    // a pending Atomics.waitAsync does not keep the thread alive, so a timer does until the ring is closed, as an open socket would
+    const keep_alive = setInterval(() => {}, 1 << 30);
+    while (true) {
+      await this.incoming.wait_async();
+      const data = this.incoming.read();
+      if (data.length) this.emit('data', data);
+      else if (this.incoming.closed) break;
+    }
+    clearInterval(keep_alive);
+    this.emit('close');
   }
+}
 
+/**
+ * Runs the database in a worker thread of the application's process, and answers the requests of a DatabaseClient through shared memory instead of a socket.
+ * Requests and results are written straight into rings in a SharedArrayBuffer that both threads map, so large results such as get_all
+ * are handed over without copies through the kernel. Each side waits with Atomics.waitAsync until the other has written, and is woken with Atomics.notify
+ *
+ * @example
+ * const client = await DatabaseWorker.start("./database/");
+ * const orders = await client.query("Orders", "get_all");
+ * @note The database must then only be used through the client, as the worker thread is the process's writer
+ */
+export class DatabaseWorker {
   /**
-   * Delete all entries from the given table where the given field starts with the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Start a worker thread connected to the database
+   * @param database_folder The path to the database root folder, ending with a slash
+   * @param read_only Reject writes to every table, see Database.connect()
+   * @param cache_size The memory budget of the worker's entry cache in bytes, see Database.connect()
+   * @param ring_size The size in bytes of each of the two rings between the threads
+   * @returns A client sending its requests to the worker. Closing the client stops the worker
    */
-  public static delete_where_starts_with(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_starts_with(fieldname, value);
+  public static async start(database_folder: string = "./database/", read_only: boolean = false, cache_size: number = 0, ring_size: number = 4 * 1024 * 1024): Promise<DatabaseClient> {
+    const requests = SharedRing.create(ring_size);
+    const responses = SharedRing.create(ring_size);
+    const worker = new worker_threads.Worker(__filename, {
+      workerData: { database_worker: { database_folder, read_only, cache_size, requests: requests.buffer, responses: responses.buffer } },
+    });
+
+    await new Promise<void>((resolve, reject) => {
+      worker.once('message', () => resolve());
+      worker.once('error', reject);
+    });
+
+    const socket = new RingSocket(responses, requests, false);
+    const client = new DatabaseClient(socket);
+    socket.pump_async();
+    return client;
   }
 
   /**
-   * Delete all entries from the given table where the given field ends with the given value
-   * @param tablename The name of the table to delete the entries from
-   * @param fieldname The name of the field to compare the given value with
-   * @param value The value to compare the given field with
-   * @throws Error if the table does not exist
-   * @throws Error if the database is not connected
+   * Connect to the database in the worker thread and answer requests until the client is closed
    */
-  public static delete_where_ends_with(tablename: string, fieldname: fieldname, value: string): void {
-    const table = this.get_table(tablename);
-    table.delete_where_ends_with(fieldname, value);
+  public static async serve(options: { database_folder: string, read_only: boolean, cache_size: number, requests: SharedArrayBuffer, responses: SharedArrayBuffer }): Promise<void> {
+    Database.connect(options.database_folder, options.read_only, options.cache_size);
+    const socket = new RingSocket(new SharedRing(options.requests), new SharedRing(options.responses), true);
+    new DatabaseServer().serve(socket);
+    worker_threads.parentPort.postMessage("ready");
+    // the event loop keeps running while the worker waits for requests, so the server's scheduling turns run
+    await socket.pump_async();
+    socket.end();
+    Database.disconnect();
   }
 }
+
+if (worker_threads.workerData?.database_worker) DatabaseWorker.serve(worker_threads.workerData.database_worker);